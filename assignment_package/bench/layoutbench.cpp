@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Times the block order inside a Chunk section under the reads the mesher
+// makes, for three orders in one binary:
+//  - the old one, x + 16y + 256z (the section form of the flat Chunk's
+//    x + 16y + 4096z),
+//  - Y innermost, y + 16z + 256x, which ChunkSection stores,
+//  - Morton (Z-order), interleaving the bits of y, z and x.
+// Sections are packed the way PaletteStorage packs them, 4 bits per
+// block, and decoded one block at a time like PaletteStorage::get() and
+// read(). Build it on its own (qmake bench/layoutbench.pro && make).
+
+static const int N = 16;
+static const int VOLUME = N * N * N;
+
+// Same bit order as ChunkSection::maskBit: each 16-bit run is a column
+static int maskBit(int x, int y, int z) {
+    return y + N * (z + N * x);
+}
+
+static unsigned int oldIndex(unsigned int x, unsigned int y, unsigned int z) {
+    return x + N * y + N * N * z;
+}
+
+static unsigned int yInnerIndex(unsigned int x, unsigned int y, unsigned int z) {
+    return y + N * (z + N * x);
+}
+
+// Spreads the low 4 bits of v so that there are two zero bits
+// between each of them
+static unsigned int spreadBits(unsigned int v) {
+    v &= 0xf;
+    v = (v | (v << 4)) & 0x0c3;
+    v = (v | (v << 2)) & 0x249;
+    return v;
+}
+
+static unsigned int mortonIndex(unsigned int x, unsigned int y, unsigned int z) {
+    return spreadBits(y) | (spreadBits(z) << 1) | (spreadBits(x) << 2);
+}
+
+typedef unsigned int (*IndexFn)(unsigned int, unsigned int, unsigned int);
+
+// One section's blocks, packed like PaletteStorage. bits is read at run
+// time there too, so the compiler cannot fold the shifts.
+template<IndexFn Index>
+struct Section {
+    std::vector<uint64_t> words;
+    std::vector<uint8_t> palette;
+    unsigned int bits;
+
+    uint8_t get(int x, int y, int z) const {
+        unsigned int bit = Index(x, y, z) * bits;
+        return palette[(words[bit >> 6] >> (bit & 63)) & ((1ull << bits) - 1)];
+    }
+};
+
+// Block types 0 (air) to 12, as in BlockType. The surface lies across
+// the middle of the section, with a few blocks of mixed ground on top of
+// stone, which is what the sections the mesher works hardest on hold.
+static std::vector<uint8_t> makeBlocks() {
+    std::vector<uint8_t> blocks(VOLUME);
+    uint32_t seed = 3;
+    for(int x = 0; x < N; ++x) {
+        for(int z = 0; z < N; ++z) {
+            int height = 4 + (x * 7 + z * 13) % 9;
+            for(int y = 0; y < N; ++y) {
+                seed = seed * 1664525u + 1013904223u;
+                uint8_t t = y >= height ? 0 : y < height - 4 ? 12 : 1 + (seed >> 16) % 11;
+                blocks[x + N * (y + N * z)] = t;
+            }
+        }
+    }
+    return blocks;
+}
+
+template<IndexFn Index>
+static Section<Index> pack(const std::vector<uint8_t> &blocks) {
+    Section<Index> s;
+    s.bits = 4;
+    s.words.assign(VOLUME * s.bits / 64, 0);
+    for(int t = 0; t < 16; ++t) {
+        s.palette.push_back(t);
+    }
+    for(int x = 0; x < N; ++x) {
+        for(int y = 0; y < N; ++y) {
+            for(int z = 0; z < N; ++z) {
+                unsigned int bit = Index(x, y, z) * s.bits;
+                s.words[bit >> 6] |= static_cast<uint64_t>(blocks[x + N * (y + N * z)]) << (bit & 63);
+            }
+        }
+    }
+    return s;
+}
+
+// Every occupied block's mask bit, reading the section the way
+// ChunkSection::buildMasks, and buildMask for a single type, do
+template<IndexFn Index>
+static unsigned long buildMasks(const Section<Index> &s, std::array<uint64_t, VOLUME / 64> *mask) {
+    mask->fill(0);
+    for(int x = 0; x < N; ++x) {
+        for(int z = 0; z < N; ++z) {
+            for(int y = 0; y < N; ++y) {
+                int bit = maskBit(x, y, z);
+                (*mask)[bit >> 6] |= static_cast<uint64_t>(s.get(x, y, z) != 0) << (bit & 63);
+            }
+        }
+    }
+    return (*mask)[0];
+}
+
+// The type of every visible face, read in the order the mesher's
+// emitFaces walks the culled masks: direction, x, then each mask word's
+// set bits, which run up each column in turn
+template<IndexFn Index>
+static unsigned long readFaces(const Section<Index> &s,
+                               const std::array<std::array<uint64_t, VOLUME / 64>, 6> &faces) {
+    unsigned long sum = 0;
+    for(int d = 0; d < 6; ++d) {
+        for(int w = 0; w < VOLUME / 64; ++w) {
+            uint64_t word = faces[d][w];
+            while(word != 0) {
+                int i = __builtin_ctzll(word);
+                word &= word - 1;
+                int bit = w * 64 + i;
+                sum += s.get(bit >> 8, bit & 15, (bit >> 4) & 15);
+            }
+        }
+    }
+    return sum;
+}
+
+// Whole columns, lowest block first, the way level-of-detail meshing
+// reads them through ChunkSection::readColumn
+template<IndexFn Index>
+static unsigned long readColumns(const Section<Index> &s) {
+    unsigned long sum = 0;
+    std::array<uint8_t, N> column;
+    for(int x = 0; x < N; ++x) {
+        for(int z = 0; z < N; ++z) {
+            for(int y = 0; y < N; ++y) {
+                column[y] = s.get(x, y, z);
+            }
+            sum += column[0] + column[N - 1];
+        }
+    }
+    return sum;
+}
+
+// The faces the mesher keeps: those of occupied blocks whose neighbour in
+// each direction, in the order of Direction, is air. Blocks outside the
+// section count as solid, except above it.
+static std::array<std::array<uint64_t, VOLUME / 64>, 6> visibleFaces(const std::vector<uint8_t> &blocks) {
+    static const int step[6][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    std::array<std::array<uint64_t, VOLUME / 64>, 6> faces{};
+    for(int d = 0; d < 6; ++d) {
+        for(int x = 0; x < N; ++x) {
+            for(int y = 0; y < N; ++y) {
+                for(int z = 0; z < N; ++z) {
+                    int nx = x + step[d][0], ny = y + step[d][1], nz = z + step[d][2];
+                    bool inside = nx >= 0 && nx < N && ny >= 0 && ny < N && nz >= 0 && nz < N;
+                    bool open = inside ? blocks[nx + N * (ny + N * nz)] == 0 : ny >= N;
+                    if(blocks[x + N * (y + N * z)] != 0 && open) {
+                        int bit = maskBit(x, y, z);
+                        faces[d][bit >> 6] |= 1ull << (bit & 63);
+                    }
+                }
+            }
+        }
+    }
+    return faces;
+}
+
+// Microseconds f takes over the section, from the best of 200 runs of
+// 100 calls each
+template<typename F>
+static double best(F f, unsigned long *sum) {
+    double result = 1e9;
+    for(int run = 0; run < 200; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        for(int i = 0; i < 100; ++i) {
+            *sum += f();
+        }
+        result = std::min(result, std::chrono::duration<double, std::micro>(
+                                  std::chrono::steady_clock::now() - start).count() / 100);
+    }
+    return result;
+}
+
+template<IndexFn Index>
+static void timeLayout(const char *name, const std::vector<uint8_t> &blocks, unsigned long *sum) {
+    Section<Index> s = pack<Index>(blocks);
+    std::array<std::array<uint64_t, VOLUME / 64>, 6> faces = visibleFaces(blocks);
+    std::array<uint64_t, VOLUME / 64> mask;
+    double masks = best([&]() { return buildMasks(s, &mask); }, sum);
+    double faceReads = best([&]() { return readFaces(s, faces); }, sum);
+    double columns = best([&]() { return readColumns(s); }, sum);
+    printf("%-14s masks %6.2f us, faces %6.2f us, columns %6.2f us, total %6.2f us\n",
+           name, masks, faceReads, columns, masks + faceReads + columns);
+}
+
+int main() {
+    std::vector<uint8_t> blocks = makeBlocks();
+    unsigned long sum = 0;
+    timeLayout<oldIndex>("x + 16y + 256z", blocks, &sum);
+    timeLayout<yInnerIndex>("Y innermost", blocks, &sum);
+    timeLayout<mortonIndex>("Morton", blocks, &sum);
+    // Printing the sum keeps the reads from being optimized away
+    printf("(%lu)\n", sum);
+    return 0;
+}
@@ -0,0 +1,14 @@
+# Headless microbenchmark for the block order inside a Chunk section.
+# Build it on its own (qmake bench/layoutbench.pro && make) and run it;
+# it times every order it compares in the one binary.
+CONFIG -= qt
+
+TARGET = layoutbench
+TEMPLATE = app
+CONFIG += console
+CONFIG += c++1z
+CONFIG -= app_bundle
+CONFIG += release
+
+SOURCES += \
+    layoutbench.cpp
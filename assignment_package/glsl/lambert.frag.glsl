@@ -1,5 +1,6 @@
 #version 150
-// ^ Change this to version 130 if you have compatibility issues
+// ^ Must stay at least 140 like lambert.vert.glsl, whose face buffer
+//   texture (usamplerBuffer) needs it
 
 // This is a fragment shader. If you've opened this file first, please
 // open and read lambert.vert.glsl before reading on.
@@ -21,7 +22,7 @@ in vec4 fs_Pos;
 in vec4 fs_Nor;
 in vec4 fs_LightVec;
 in vec4 fs_Col;
-in vec2 fs_UV;
+in vec2 fs_UV;              // The lower-left corner of the face's texture tile
 in float fs_Animateable;
 
 out vec4 out_Col; // This is the final output color that you will see on your
@@ -82,6 +83,26 @@ vec3 rotateX(vec3 p, float a) {
     return vec3(p.x, (cos(a) * p.y - sin(a) * p.z), (sin(a) * p.y + cos(a) * p.z));
 }
 
+// Where in its block's face a fragment lies, from 0 to 1 on each axis,
+// oriented the way the Chunk's faces are (see corners in
+// lambert.vert.glsl). Faces that were merged span several blocks, so
+// this repeats once per block.
+vec2 faceUV(vec3 p, vec3 n) {
+    vec3 f = fract(p);
+    if (n.x > 0.5) {
+        return vec2(1 - f.z, f.y);
+    } else if (n.x < -0.5) {
+        return vec2(f.z, f.y);
+    } else if (n.y > 0.5) {
+        return vec2(f.x, 1 - f.z);
+    } else if (n.y < -0.5) {
+        return vec2(f.x, f.z);
+    } else if (n.z > 0.5) {
+        return vec2(f.x, f.y);
+    }
+    return vec2(1 - f.x, f.y);
+}
+
 void main()
 {
     // Material base color (before shading)
@@ -106,7 +127,8 @@ void main()
         if (fs_Animateable > 0) {
             offset.x = u_Time % 100 * 0.01 / 16;
         }
-        out_Col = vec4(texture(u_Texture, vec2(fs_UV + offset)));
+        vec2 uv = fs_UV + faceUV(fs_Pos.xyz, fs_Nor.xyz) / 16;
+        out_Col = vec4(texture(u_Texture, vec2(uv + offset)));
         out_Col.rgb *= lightIntensity;
         //out_Col = vec4(fs_UV, 0, 1);
 }
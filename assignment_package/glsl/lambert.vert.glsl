@@ -1,5 +1,5 @@
 #version 150
-// ^ Change this to version 130 if you have compatibility issues
+// ^ The face buffer texture (usamplerBuffer) needs at least version 140
 
 //This is a vertex shader. While it is called a "shader" due to outdated conventions, this file
 //is used to apply matrix transformations to the arrays of vertex data passed to it.
@@ -22,14 +22,10 @@ uniform mat4 u_ViewProj;    // The matrix that defines the camera's transformati
 
 uniform vec4 u_Color;       // When drawing the cube instance, we'll set our uniform color to represent different block types.
 
-in vec4 vs_Pos;             // The array of vertex positions passed to the shader
-
-in vec4 vs_Nor;             // The array of vertex normals passed to the shader
-
-in vec4 vs_Col;             // The array of vertex colors passed to the shader.
-
-in vec2 vs_UV;
-in float vs_Animateable;
+uniform usamplerBuffer u_Faces; // The Chunk's faces, one texel each (see ChunkFace in chunkmesh.h):
+                                // x holds the face's Chunk-local position and y its direction,
+                                // animation flag, atlas tile and size. Corner c of face f is
+                                // drawn as vertex 4f + c.
 
 out vec4 fs_Pos;
 out vec4 fs_Nor;            // The array of normals that has been transformed by u_ModelInvTr. This is implicitly passed to the fragment shader.
@@ -42,12 +38,44 @@ out float fs_Animateable;
 const vec4 lightDir = normalize(vec4(0.5, 1, 0.75, 0));  // The direction of our virtual light, which is used to compute the shading of
                                         // the geometry in the fragment shader.
 
+const float WORLD_MIN_Y = -2048;        // Must match WORLD_MIN_Y in chunkdata.h
+
+// The normal of each Direction, in the order they are declared in
+const vec4 normals[6] = vec4[6](vec4(1, 0, 0, 0), vec4(-1, 0, 0, 0),
+                                vec4(0, 1, 0, 0), vec4(0, -1, 0, 0),
+                                vec4(0, 0, 1, 0), vec4(0, 0, -1, 0));
+
+// The four corners of a one-block face in each Direction, in the order
+// the quad indices visit them: counter-clockwise seen from outside the
+// block, starting from the corner whose UV is (0, 0), so that corner 1
+// lies along the face's U axis and corner 3 along its V axis. This is
+// the only place the corners are kept.
+const vec3 corners[24] = vec3[24](
+    vec3(1, 0, 1), vec3(1, 0, 0), vec3(1, 1, 0), vec3(1, 1, 1),   // +X
+    vec3(0, 0, 0), vec3(0, 0, 1), vec3(0, 1, 1), vec3(0, 1, 0),   // -X
+    vec3(0, 1, 1), vec3(1, 1, 1), vec3(1, 1, 0), vec3(0, 1, 0),   // +Y
+    vec3(0, 0, 0), vec3(1, 0, 0), vec3(1, 0, 1), vec3(0, 0, 1),   // -Y
+    vec3(0, 0, 1), vec3(1, 0, 1), vec3(1, 1, 1), vec3(0, 1, 1),   // +Z
+    vec3(1, 0, 0), vec3(0, 0, 0), vec3(0, 1, 0), vec3(1, 1, 0));  // -Z
+
 void main()
 {
-    fs_UV = vs_UV;
-    fs_Animateable = vs_Animateable;
+    uvec2 record = texelFetch(u_Faces, gl_VertexID >> 2).xy;
+    uint position = record.x;
+    uint face = record.y;
+    uint dir = face & 7u;
+    vec3 origin = vec3(float(position & 31u),
+                       float((position >> 10) & 8191u) + WORLD_MIN_Y,
+                       float((position >> 5) & 31u));
+    vec3 size = vec3((face >> 12) & 15u, (face >> 16) & 15u, (face >> 20) & 15u) + 1.0;
+    vec4 vs_Pos = vec4(origin + corners[4u * dir + uint(gl_VertexID & 3)] * size, 1);
+    vec4 vs_Nor = normals[dir];
+    uint tile = (face >> 4) & 255u;
+
+    fs_UV = vec2(tile & 15u, tile >> 4) / 16;
+    fs_Animateable = float((face >> 3) & 1u);
     fs_Pos = vs_Pos;
-    fs_Col = vs_Col;                         // Pass the vertex colors to the fragment shader for interpolation
+    fs_Col = vec4(1, 0, 0, 1);               // Every Chunk vertex is the same color
 
     mat3 invTranspose = mat3(u_ModelInvTr);
     fs_Nor = vec4(invTranspose * vec3(vs_Nor), 0);          // Pass the vertex normals to the fragment shader for interpolation.
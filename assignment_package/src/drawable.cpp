@@ -2,8 +2,8 @@
 #include <glm_includes.h>
 
 Drawable::Drawable(OpenGLContext* context)
-    : m_count(-1), m_bufIdx(), m_bufPos(), m_bufNor(), m_bufCol(), m_bufUV(), m_transBufIdx(), m_transBufPosNorCol(), m_transBufUV(),
-      m_idxGenerated(false), m_posGenerated(false), m_norGenerated(false), m_colGenerated(false), m_uvGenerated(false),
+    : m_count(-1), m_bufIdx(), m_bufPos(), m_bufNor(), m_bufCol(), m_bufPosNorCol(), m_bufUV(), m_transBufIdx(), m_transBufPosNorCol(), m_transBufUV(),
+      m_idxGenerated(false), m_posGenerated(false), m_norGenerated(false), m_colGenerated(false), m_posNorColGenerated(false), m_uvGenerated(false),
       m_transIdxGenerated(false), m_transPosNorColGenerated(false), m_transUVGenerated(false),
       mp_context(context)
 {}
@@ -47,6 +47,9 @@ int Drawable::elemCount()
 
 void Drawable::generateIdx()
 {
+    if(m_idxGenerated) {
+        return;
+    }
     m_idxGenerated = true;
     // Create a VBO on our GPU and store its handle in bufIdx
     mp_context->glGenBuffers(1, &m_bufIdx);
@@ -54,6 +57,9 @@ void Drawable::generateIdx()
 
 void Drawable::generatePos()
 {
+    if(m_posGenerated) {
+        return;
+    }
     m_posGenerated = true;
     // Create a VBO on our GPU and store its handle in bufPos
     mp_context->glGenBuffers(1, &m_bufPos);
@@ -61,6 +67,9 @@ void Drawable::generatePos()
 
 void Drawable::generateNor()
 {
+    if(m_norGenerated) {
+        return;
+    }
     m_norGenerated = true;
     // Create a VBO on our GPU and store its handle in bufNor
     mp_context->glGenBuffers(1, &m_bufNor);
@@ -68,6 +77,9 @@ void Drawable::generateNor()
 
 void Drawable::generateCol()
 {
+    if(m_colGenerated) {
+        return;
+    }
     m_colGenerated = true;
     // Create a VBO on our GPU and store its handle in bufCol
     mp_context->glGenBuffers(1, &m_bufCol);
@@ -76,27 +88,42 @@ void Drawable::generateCol()
 // Milestone 1
 void Drawable::generatePosNorCol()
 {
+    if(m_posNorColGenerated) {
+        return;
+    }
     m_posNorColGenerated = true;
     // Create a VBO on our GPU and store its handle in bufCol
     mp_context->glGenBuffers(1, &m_bufPosNorCol);
 }
 
 void Drawable::generateUV() {
+    if(m_uvGenerated) {
+        return;
+    }
     m_uvGenerated = true;
     mp_context->glGenBuffers(1, &m_bufUV);
 }
 
 void Drawable::generateTransIdx() {
+    if(m_transIdxGenerated) {
+        return;
+    }
     m_transIdxGenerated = true;
     mp_context->glGenBuffers(1, &m_transBufIdx);
 }
 
 void Drawable::generateTransPosNorCol(){
+    if(m_transPosNorColGenerated) {
+        return;
+    }
     m_transPosNorColGenerated = true;
     mp_context->glGenBuffers(1, &m_transBufPosNorCol);
 }
 
 void Drawable::generateTransUV() {
+    if(m_transUVGenerated) {
+        return;
+    }
     m_transUVGenerated = true;
     mp_context->glGenBuffers(1, &m_transBufUV);
 }
@@ -149,7 +176,7 @@ bool Drawable::bindUV() {
 
 bool Drawable::bindTransIdx() {
     if (m_transIdxGenerated) {
-        mp_context->glBindBuffer(GL_ARRAY_BUFFER, m_transBufIdx);
+        mp_context->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_transBufIdx);
     }
     return m_transIdxGenerated;
 }
@@ -49,7 +49,7 @@ public:
     virtual ~Drawable();
 
     virtual void create() = 0; // To be implemented by subclasses. Populates the VBOs of the Drawable.
-    void destroy(); // Frees the VBOs of the Drawable.
+    virtual void destroy(); // Frees the VBOs of the Drawable.
 
     // Getter functions for various GL data
     virtual GLenum drawMode();
@@ -57,6 +57,8 @@ public:
 
     // Call these functions when you want to call glGenBuffers on the buffers stored in the Drawable
     // These will properly set the values of idxBound etc. which need to be checked in ShaderProgram::draw()
+    // Calling one again keeps the existing buffer, so that re-uploading a mesh
+    // overwrites its old data instead of leaking it
     void generateIdx();
     void generatePos();
     void generateNor();
@@ -5,6 +5,7 @@
 #include <QApplication>
 #include <QKeyEvent>
 #include <QDateTime>
+#include <QStandardPaths>
 
 MyGL::MyGL(QWidget *parent)
     : OpenGLContext(parent),
@@ -88,6 +89,14 @@ void MyGL::initializeGL()
     // using multiple VAOs, we can just bind one once.
     glBindVertexArray(vao);
 
+    // Keep the meshes of generated Chunks between sessions, so that
+    // revisited terrain skips meshing. The directory is capped at
+    // MeshCache's disk budget.
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if(!cacheDir.isEmpty()) {
+        m_terrain.setMeshCacheDirectory((cacheDir + "/meshes").toStdString());
+    }
+
     m_terrain.CreateTestScene();
 }
 
@@ -144,6 +153,11 @@ void MyGL::sendPlayerDataToGUI() const {
     glm::ivec2 zone(64 * glm::ivec2(glm::floor(pPos / 64.f)));
     emit sig_sendPlayerChunk(QString::fromStdString("( " + std::to_string(chunk.x) + ", " + std::to_string(chunk.y) + " )"));
     emit sig_sendPlayerTerrainZone(QString::fromStdString("( " + std::to_string(zone.x) + ", " + std::to_string(zone.y) + " )"));
+    MeshCacheStats cache = m_terrain.meshCacheStats();
+    emit sig_sendMeshCacheStats(QString("%1% hits (%2 memory, %3 disk, %4 built), %5 + %6 MB")
+                                .arg(static_cast<int>(100 * cache.hitRate()))
+                                .arg(cache.memoryHits).arg(cache.diskHits).arg(cache.misses)
+                                .arg(cache.memoryBytes >> 20).arg(cache.diskBytes >> 20));
 }
 
 /**
@@ -188,18 +202,23 @@ void MyGL::paintGL() {
 }
 
 /*
- * Renders the nine zones of generated terrain that
- * surround the player (refer to Terrain::m_generatedTerrain
- * for more info)
+ * Renders the Chunks within the Terrain's view distance of
+ * the player, the distant ones at a lower level of detail
+ * (refer to Terrain::m_lodRings for more info), and only their
+ * sections within the Terrain's vertical radius
  */
 void MyGL::renderTerrain() {
     m_texture.bind(0);
     glm::vec3 p = m_player.mcr_position;
     int xFloor = glm::floor(p.x / 16.f) * 16.f;
+    int yFloor = glm::floor(p.y / 16.f) * 16.f;
     int zFloor = glm::floor(p.z / 16.f) * 16.f;
+    int d = m_terrain.viewDistance();
+    int v = m_terrain.verticalRadius();
 
-    m_terrain.draw(xFloor - 2 * X_BOUND, xFloor + 2 * X_BOUND,
-                   zFloor - 2 * Z_BOUND, zFloor + 2 * Z_BOUND,
+    m_terrain.draw(xFloor - d * X_BOUND, xFloor + d * X_BOUND,
+                   yFloor - v * SECTION_HEIGHT, yFloor + (v + 1) * SECTION_HEIGHT,
+                   zFloor - d * Z_BOUND, zFloor + d * Z_BOUND,
                    &m_progLambert);
 }
 
@@ -261,8 +280,8 @@ void MyGL::mouseMoveEvent(QMouseEvent *e) {
 
 void MyGL::mousePressEvent(QMouseEvent *e) {
     if (e->button() == Qt::LeftButton) {
-        m_player.removeBlock();
+        m_player.removeBlock(m_terrain);
     } else {
-        m_player.addBlock();
+        m_player.addBlock(m_terrain);
     }
 }
@@ -36,3 +36,7 @@ void PlayerInfo::slot_setZoneText(QString s) {
     ui->zoneLabel->setText(s);
 }
 
+void PlayerInfo::slot_setMeshCacheText(QString s) {
+    ui->meshCacheLabel->setText(s);
+}
+
@@ -20,6 +20,7 @@ public slots:
     void slot_setLookText(QString);
     void slot_setChunkText(QString);
     void slot_setZoneText(QString);
+    void slot_setMeshCacheText(QString);
 
 private:
     Ui::PlayerInfo *ui;
@@ -0,0 +1,117 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Every block type and everything the game needs to know about each one,
+// fixed at compile time. To add a block type, add it to the end of
+// BlockType and give it a row in BLOCK_INFO.
+
+// C++ 11 allows us to define the size of an enum. This lets us use only one byte
+// of memory to store our different block types. By default, the size of a C++ enum
+// is that of an int (so, usually four bytes). This *does* limit us to only 256 different
+// block types, but in the scope of this project we'll never get anywhere near that many.
+enum BlockType : unsigned char
+{
+    EMPTY, GRASS, DIRT, STONE, SNOW, SAND, WATER, LAVA, OREA, OREB, OREC, ORED,
+    BLOCK_TYPE_COUNT
+};
+
+// The six cardinal directions in 3D space
+enum Direction : unsigned char
+{
+    XPOS, XNEG, YPOS, YNEG, ZPOS, ZNEG
+};
+
+// What happens to things that run into a block
+enum class Collision : unsigned char
+{
+    NONE,   // Passed straight through
+    SOLID,  // Stops them
+    LIQUID  // Slows them down
+};
+
+struct BlockInfo {
+    // Atlas tile of the face in each Direction, as column + 16 * row
+    // counted from the bottom of the atlas
+    std::array<uint8_t, 6> tiles;
+    // Can be seen through. Transparent faces are drawn in their own
+    // pass, and only hidden by opaque blocks and blocks of their own type.
+    bool transparent;
+    // Its texture scrolls over time
+    bool animated;
+    Collision collision;
+    // What the terrain generators fill a column with underneath a
+    // surface block of this type
+    BlockType subsoil;
+};
+
+namespace blockinfo_detail {
+
+constexpr uint8_t tile(int column, int row) {
+    return static_cast<uint8_t>(column + 16 * row);
+}
+
+// A block that looks the same from every side
+constexpr BlockInfo uniform(uint8_t t, bool liquid, BlockType self) {
+    return {{t, t, t, t, t, t}, liquid, liquid,
+            liquid ? Collision::LIQUID : Collision::SOLID, self};
+}
+
+}
+
+// Indexed by BlockType
+constexpr std::array<BlockInfo, BLOCK_TYPE_COUNT> BLOCK_INFO{{
+    // EMPTY
+    {{0, 0, 0, 0, 0, 0}, false, false, Collision::NONE, EMPTY},
+    // GRASS: grass on top, dirt underneath, grassy dirt on the sides
+    {{blockinfo_detail::tile(3, 15), blockinfo_detail::tile(3, 15),
+      blockinfo_detail::tile(8, 13), blockinfo_detail::tile(2, 15),
+      blockinfo_detail::tile(3, 15), blockinfo_detail::tile(3, 15)},
+     false, false, Collision::SOLID, DIRT},
+    blockinfo_detail::uniform(blockinfo_detail::tile(2, 15), false, DIRT),
+    blockinfo_detail::uniform(blockinfo_detail::tile(1, 15), false, STONE),
+    blockinfo_detail::uniform(blockinfo_detail::tile(2, 11), false, SNOW),
+    blockinfo_detail::uniform(blockinfo_detail::tile(2, 14), false, SAND),
+    blockinfo_detail::uniform(blockinfo_detail::tile(15, 3), true, WATER),
+    blockinfo_detail::uniform(blockinfo_detail::tile(15, 1), true, LAVA),
+    blockinfo_detail::uniform(blockinfo_detail::tile(2, 12), false, OREA),
+    blockinfo_detail::uniform(blockinfo_detail::tile(3, 12), false, OREB),
+    blockinfo_detail::uniform(blockinfo_detail::tile(0, 13), false, OREC),
+    blockinfo_detail::uniform(blockinfo_detail::tile(1, 13), false, ORED)
+}};
+
+constexpr const BlockInfo &blockInfo(BlockType t) {
+    return BLOCK_INFO[t];
+}
+
+constexpr uint8_t blockTile(BlockType t, Direction d) {
+    return BLOCK_INFO[t].tiles[d];
+}
+
+// Water and lava, which can be seen through and are drawn in their own pass
+constexpr bool isTransparent(BlockType t) {
+    return BLOCK_INFO[t].transparent;
+}
+
+namespace blockinfo_detail {
+
+// ChunkData's opaque and transparent masks stand in for a block's
+// Collision (see Terrain::collisionAt), which only works while every
+// opaque block is solid and every transparent one liquid
+constexpr bool collisionMatchesMasks() {
+    for(size_t t = 0; t < BLOCK_INFO.size(); ++t) {
+        const BlockInfo &info = BLOCK_INFO[t];
+        Collision expected = t == EMPTY ? Collision::NONE :
+                             info.transparent ? Collision::LIQUID : Collision::SOLID;
+        if(info.collision != expected) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+static_assert(blockinfo_detail::collisionMatchesMasks(),
+              "Block collision must follow from transparency");
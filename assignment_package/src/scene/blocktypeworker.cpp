@@ -2,16 +2,19 @@
 
 #include "blocktypeworker.h"
 
-BlockTypeWorker::BlockTypeWorker(std::vector<Chunk*>* chunks,
+BlockTypeWorker::BlockTypeWorker(std::vector<ChunkData*>* chunks,
                                  QMutex *mutex,
-                                 std::vector<Chunk*> add,
+                                 std::vector<ChunkData*> add,
                                  int x,
                                  int z,
-                                 std::unordered_map<int64_t, std::pair<glm::vec2, Biomes>> biomeMap) :
+                                 std::unordered_map<int64_t, std::pair<glm::vec2, Biomes>> biomeMap,
+                                 int minSection,
+                                 int maxSection) :
     chunks(chunks), mutex(mutex), add(add),
-    x(x), z(z), biomeMap(biomeMap) {}
+    x(x), z(z), biomeMap(biomeMap),
+    minSection(minSection), maxSection(maxSection) {}
 
-Chunk* BlockTypeWorker::createBlockData(Chunk *cPtr){
+ChunkData* BlockTypeWorker::createBlockData(ChunkData *cPtr){
 
     // Added these getters in case they are necessary for noise functions
     int chunkX = (int)cPtr->getWorldSpaceX();
@@ -24,6 +27,10 @@ Chunk* BlockTypeWorker::createBlockData(Chunk *cPtr){
 
     std::pair<glm::vec2, Biomes> p = biomeMap[key];
 
+    int yMin = sectionFloor(minSection);
+    int yMax = sectionFloor(maxSection) + SECTION_HEIGHT - 1;
+    // Everything below the generated band is stone, whole sections of it
+    cPtr->fillBox(glm::ivec3(0, yMin, 0), glm::ivec3(X_BOUND - 1, glm::min(yMax, -1), Z_BOUND - 1), STONE);
 
     for(int i = 0; i < X_BOUND; ++i) {
         for(int j = 0; j < Z_BOUND; ++j) {
@@ -37,23 +44,29 @@ Chunk* BlockTypeWorker::createBlockData(Chunk *cPtr){
             glm::vec2 noise = p.first;
             BlockType block = nf->biomeBlock(glm::vec3(x, z, blockHeight), b, noise, biomeMap);
 
-            // only top block should be grass, rest should be dirt
-            for(int y = 0; y < blockHeight; ++y) {
-                 BlockType toSet = (block == GRASS && y < blockHeight - 1) ? DIRT : block;
-                cPtr->setBlockAt(i, y, j, toSet);
+            // Only the top block is the biome's; the rest is its subsoil
+            // (grass sits on dirt)
+            int top = static_cast<int>(glm::ceil(blockHeight)) - 1;
+            cPtr->fillColumn(i, j, glm::max(0, yMin), glm::min(top - 1, yMax), blockInfo(block).subsoil);
+            if(top >= yMin && top <= yMax) {
+                cPtr->fillColumn(i, j, top, top, block);
             }
 
         }
     }
 
+    // Overwritten block types can leave unused entries in the palette
+    cPtr->compactBlocks();
+    cPtr->publish();
+
     return cPtr;
 }
 
 void BlockTypeWorker::run(){
-    for (Chunk *c : add) createBlockData(c);
+    for (ChunkData *c : add) createBlockData(c);
 
     // Critical section
     mutex->lock();
-    for(Chunk *c : add) chunks->push_back(c);
+    for(ChunkData *c : add) chunks->push_back(c);
     mutex->unlock();
 }
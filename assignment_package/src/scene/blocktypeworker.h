@@ -5,7 +5,7 @@
 
 #include <QRunnable>
 #include <QMutex>
-#include "chunk.h"
+#include "chunkdata.h"
 #include "noisefunctions.h"
 #include "river.h"
 
@@ -13,23 +13,28 @@ class BlockTypeWorker : public QRunnable
 {
 
 private:
-    std::vector<Chunk*> *chunks;
+    std::vector<ChunkData*> *chunks;
     QMutex *mutex;
-    std::vector<Chunk*> add;
+    std::vector<ChunkData*> add;
     int x;
     int z;
     int seed;
     std::unordered_map<int64_t, std::pair<glm::vec2, Biomes>> biomeMap;
+    // Only sections minSection to maxSection are generated
+    int minSection;
+    int maxSection;
 
 public:
-    BlockTypeWorker(std::vector<Chunk*> *chunks,
+    BlockTypeWorker(std::vector<ChunkData*> *chunks,
                     QMutex *mutex,
-                    std::vector<Chunk*> add,
+                    std::vector<ChunkData*> add,
                     int x,
                     int z,
-                    std::unordered_map<int64_t, std::pair<glm::vec2, Biomes>> biomeMap);
+                    std::unordered_map<int64_t, std::pair<glm::vec2, Biomes>> biomeMap,
+                    int minSection,
+                    int maxSection);
     void run() override;
-    Chunk* createBlockData(Chunk *cPtr);
+    ChunkData* createBlockData(ChunkData *cPtr);
 
 };
 
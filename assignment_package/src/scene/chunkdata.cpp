@@ -0,0 +1,962 @@
+#include "chunkdata.h"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+PaletteStorage::PaletteStorage(unsigned int size, BlockType fill) :
+    m_palette{fill}, m_words(), m_bits(0), m_size(size)
+{}
+
+unsigned int PaletteStorage::paletteIndex(unsigned int i) const {
+    if(m_bits == 0)
+        return 0;
+    unsigned int bit = i * m_bits;
+    return (m_words[bit >> 6] >> (bit & 63)) & ((1ull << m_bits) - 1);
+}
+
+void PaletteStorage::setPaletteIndex(unsigned int i, unsigned int p) {
+    unsigned int bit = i * m_bits;
+    uint64_t mask = ((1ull << m_bits) - 1) << (bit & 63);
+    uint64_t &word = m_words[bit >> 6];
+    word = (word & ~mask) | (static_cast<uint64_t>(p) << (bit & 63));
+}
+
+void PaletteStorage::resize(unsigned int bits) {
+    PaletteStorage old = *this;
+    m_bits = bits;
+    m_words.assign(bits == 0 ? 0 : (static_cast<size_t>(m_size) * bits + 63) / 64, 0);
+    if(bits == 0)
+        return;
+    for(unsigned int i = 0; i < m_size; ++i) {
+        setPaletteIndex(i, old.paletteIndex(i));
+    }
+}
+
+BlockType PaletteStorage::get(unsigned int i) const {
+    return m_palette[paletteIndex(i)];
+}
+
+unsigned int PaletteStorage::paletteSlot(BlockType t) {
+    unsigned int p = 0;
+    while(p < m_palette.size() && m_palette[p] != t) {
+        ++p;
+    }
+    if(p == m_palette.size()) {
+        m_palette.push_back(t);
+        if(m_palette.size() > (1u << m_bits)) {
+            resize(m_bits == 0 ? 1 : m_bits * 2);
+        }
+    }
+    return p;
+}
+
+void PaletteStorage::set(unsigned int i, BlockType t) {
+    unsigned int p = paletteSlot(t);
+    if(m_bits != 0) {
+        setPaletteIndex(i, p);
+    }
+}
+
+void PaletteStorage::fill(unsigned int first, unsigned int count, BlockType t) {
+    if(first == 0 && count == m_size) {
+        *this = PaletteStorage(m_size, t);
+        return;
+    }
+    unsigned int p = paletteSlot(t);
+    if(m_bits == 0 || count == 0) {
+        return;
+    }
+
+    // p repeated across a whole word. Indices never straddle words, so
+    // every run of them within a word lines up with this pattern.
+    uint64_t pattern = 0;
+    for(unsigned int bit = 0; bit < 64; bit += m_bits) {
+        pattern |= static_cast<uint64_t>(p) << bit;
+    }
+    unsigned int bit = first * m_bits;
+    unsigned int end = (first + count) * m_bits;
+    while(bit < end) {
+        unsigned int offset = bit & 63;
+        unsigned int n = std::min(64 - offset, end - bit);
+        uint64_t mask = (n == 64 ? ~0ull : (1ull << n) - 1) << offset;
+        uint64_t &word = m_words[bit >> 6];
+        word = (word & ~mask) | (pattern & mask);
+        bit += n;
+    }
+}
+
+void PaletteStorage::read(unsigned int first, unsigned int count, BlockType *out) const {
+    if(m_bits == 0) {
+        std::fill_n(out, count, m_palette[0]);
+        return;
+    }
+    for(unsigned int i = 0; i < count; ++i) {
+        out[i] = m_palette[paletteIndex(first + i)];
+    }
+}
+
+void PaletteStorage::compact() {
+    std::array<bool, 256> used{};
+    for(unsigned int i = 0; i < m_size; ++i) {
+        used[paletteIndex(i)] = true;
+    }
+
+    // Map every palette entry that is still referenced to its new slot
+    std::vector<BlockType> palette;
+    std::array<unsigned int, 256> remap{};
+    for(unsigned int p = 0; p < m_palette.size(); ++p) {
+        if(used[p]) {
+            remap[p] = palette.size();
+            palette.push_back(m_palette[p]);
+        }
+    }
+    if(palette.size() == m_palette.size())
+        return;
+
+    unsigned int bits = 0;
+    while((1u << bits) < palette.size()) {
+        bits = bits == 0 ? 1 : bits * 2;
+    }
+
+    PaletteStorage old = *this;
+    m_palette = palette;
+    m_bits = bits;
+    m_words.assign(bits == 0 ? 0 : (static_cast<size_t>(m_size) * bits + 63) / 64, 0);
+    if(bits == 0)
+        return;
+    for(unsigned int i = 0; i < m_size; ++i) {
+        setPaletteIndex(i, remap[old.paletteIndex(i)]);
+    }
+}
+
+bool PaletteStorage::isUniform() const {
+    return m_bits == 0;
+}
+
+const std::vector<BlockType> &PaletteStorage::palette() const {
+    return m_palette;
+}
+
+unsigned int PaletteStorage::paletteSize() const {
+    return m_palette.size();
+}
+
+size_t PaletteStorage::memoryUsage() const {
+    return m_palette.capacity() * sizeof(BlockType) +
+           m_words.capacity() * sizeof(uint64_t);
+}
+
+// The storage every all-air section starts out sharing. The reference
+// held here keeps it shared, so writableSection never writes to it.
+static const std::shared_ptr<ChunkSection> &emptySection() {
+    static const std::shared_ptr<ChunkSection> empty = std::make_shared<ChunkSection>();
+    return empty;
+}
+
+ChunkData::ChunkData(float x, float z) :
+    m_sections(),
+    m_minSection(sectionOf(0)),
+    m_surfaceHeight(),
+    m_surfaceType(),
+    m_neighbors{},
+    worldX(x),
+    worldZ(z),
+    m_edited(false),
+    m_dirtySections(),
+    m_frozen(false),
+    m_coldMutex(),
+    m_coldData(),
+    m_coldRawBytes(0),
+    m_version(0),
+    m_snapshot(){
+    m_surfaceHeight.fill(NO_SURFACE);
+    m_surfaceType.fill(EMPTY);
+    // Publish the empty Chunk right away so that snapshot() has
+    // something to return while the Chunk is still being generated
+    publish();
+}
+
+// Index of a block within its section.
+// Blocks are stored column by column with Y innermost, which is the
+// order the mesher and the terrain generators walk them in, so each
+// column is one run of consecutive indices.
+static unsigned int sectionIndex(unsigned int x, unsigned int y, unsigned int z) {
+    return (y % SECTION_HEIGHT) + SECTION_HEIGHT * (z + Z_BOUND * x);
+}
+
+ChunkSection::ChunkSection(BlockType fill) :
+    m_blocks(SECTION_VOLUME, fill), m_masks()
+{}
+
+ChunkSection::ChunkSection(const PaletteStorage &blocks) :
+    m_blocks(blocks), m_masks()
+{
+    if(!m_blocks.isUniform()) {
+        buildMasks();
+    }
+}
+
+void ChunkSection::buildMasks() {
+    m_masks.assign(2 * MASK_WORDS, 0);
+    for(int x = 0; x < X_BOUND; ++x) {
+        for(int z = 0; z < Z_BOUND; ++z) {
+            for(int y = 0; y < SECTION_HEIGHT; ++y) {
+                BlockType t = get(x, y, z);
+                int bit = maskBit(x, y, z);
+                if(t == EMPTY) {
+                    continue;
+                }
+                int word = (isTransparent(t) ? MASK_WORDS : 0) + (bit >> 6);
+                m_masks[word] |= 1ull << (bit & 63);
+            }
+        }
+    }
+}
+
+BlockType ChunkSection::get(int x, int y, int z) const {
+    return m_blocks.get(sectionIndex(x, y, z));
+}
+
+void ChunkSection::set(int x, int y, int z, BlockType t) {
+    if(m_masks.empty()) {
+        if(t == m_blocks.get(0)) {
+            return;
+        }
+        buildMasks();
+    }
+    m_blocks.set(sectionIndex(x, y, z), t);
+
+    int bit = maskBit(x, y, z);
+    uint64_t mask = 1ull << (bit & 63);
+    uint64_t &opaque = m_masks[bit >> 6];
+    uint64_t &transparent = m_masks[MASK_WORDS + (bit >> 6)];
+    opaque &= ~mask;
+    transparent &= ~mask;
+    if(isTransparent(t)) {
+        transparent |= mask;
+    } else if(t != EMPTY) {
+        opaque |= mask;
+    }
+}
+
+// Bits lo through hi (inclusive) of a section column
+static uint16_t rowRange(int lo, int hi) {
+    return static_cast<uint16_t>(((2u << hi) - 1) & ~((1u << lo) - 1));
+}
+
+void ChunkSection::fillColumn(int x, int z, int yMin, int yMax, BlockType t) {
+    if(m_masks.empty()) {
+        if(t == m_blocks.get(0)) {
+            return;
+        }
+        buildMasks();
+    }
+    // A column's blocks are stored one after another
+    m_blocks.fill(sectionIndex(x, yMin, z), yMax - yMin + 1, t);
+
+    int bit = maskBit(x, 0, z);
+    uint64_t mask = static_cast<uint64_t>(rowRange(yMin, yMax)) << (bit & 63);
+    uint64_t &opaque = m_masks[bit >> 6];
+    uint64_t &transparent = m_masks[MASK_WORDS + (bit >> 6)];
+    opaque &= ~mask;
+    transparent &= ~mask;
+    if(isTransparent(t)) {
+        transparent |= mask;
+    } else if(t != EMPTY) {
+        opaque |= mask;
+    }
+}
+
+void ChunkSection::readColumn(int x, int z, int yMin, int yMax, BlockType *out) const {
+    m_blocks.read(sectionIndex(x, yMin, z), yMax - yMin + 1, out);
+}
+
+const PaletteStorage &ChunkSection::blocks() const {
+    return m_blocks;
+}
+
+bool ChunkSection::isUniform() const {
+    return m_blocks.isUniform();
+}
+
+void ChunkSection::compact() {
+    m_blocks.compact();
+    if(m_blocks.isUniform()) {
+        std::vector<uint64_t, PoolAllocator<uint64_t>>().swap(m_masks);
+    }
+}
+
+size_t ChunkSection::memoryUsage() const {
+    return m_blocks.memoryUsage() + m_masks.capacity() * sizeof(uint64_t);
+}
+
+uint64_t ChunkSection::opaqueWord(int w) const {
+    if(m_masks.empty()) {
+        BlockType t = m_blocks.get(0);
+        return (t == EMPTY || isTransparent(t)) ? 0 : ~0ull;
+    }
+    return m_masks[w];
+}
+
+uint64_t ChunkSection::transparentWord(int w) const {
+    if(m_masks.empty()) {
+        return isTransparent(m_blocks.get(0)) ? ~0ull : 0;
+    }
+    return m_masks[MASK_WORDS + w];
+}
+
+uint16_t ChunkSection::opaqueColumn(int x, int z) const {
+    int bit = maskBit(x, 0, z);
+    return static_cast<uint16_t>(opaqueWord(bit >> 6) >> (bit & 63));
+}
+
+uint16_t ChunkSection::occupiedColumn(int x, int z) const {
+    int bit = maskBit(x, 0, z);
+    return static_cast<uint16_t>((opaqueWord(bit >> 6) | transparentWord(bit >> 6)) >> (bit & 63));
+}
+
+void *ChunkData::operator new(size_t bytes) {
+    return ChunkPool::instance().allocate(bytes);
+}
+
+void ChunkData::operator delete(void *p, size_t bytes) {
+    ChunkPool::instance().deallocate(p, bytes);
+}
+
+BlockType ChunkData::getBlockAt(unsigned int x, int y, unsigned int z) const {
+
+    if(x >= X_BOUND || y < WORLD_MIN_Y || y >= WORLD_MAX_Y || z >= Z_BOUND )
+        return BlockType::EMPTY;
+
+    ensureThawed();
+    int s = sectionOf(y);
+    return section(s).get(x, y - sectionFloor(s), z);
+}
+
+// Exists to get rid of compiler warnings about int -> unsigned int implicit conversion
+BlockType ChunkData::getBlockAt(int x, int y, int z) const {
+    if(x >= X_BOUND || x < 0)
+        return BlockType::EMPTY;
+    if(z >= Z_BOUND || z < 0)
+        return BlockType::EMPTY;
+
+    return getBlockAt(static_cast<unsigned int>(x), y, static_cast<unsigned int>(z));
+}
+
+void ChunkData::setBlockAt(unsigned int x, int y, unsigned int z, BlockType t) {
+    if(x >= X_BOUND || y < WORLD_MIN_Y || y >= WORLD_MAX_Y || z >= Z_BOUND) {
+        throw std::out_of_range("Block " + std::to_string(x) + " " +
+                                std::to_string(y) + " " + std::to_string(z) +
+                                " lies outside its Chunk!");
+    }
+    ensureThawed();
+    int s = sectionOf(y);
+    // Sections that aren't stored are air already
+    if(t == EMPTY && (s < m_minSection || s >= m_minSection + static_cast<int>(m_sections.size()))) {
+        return;
+    }
+    writableSection(s).set(x, y - sectionFloor(s), z, t);
+    ++m_version;
+    markDirty(y);
+    updateSurface(x, z, y, y, t == EMPTY ? NO_SURFACE : y, t);
+}
+
+void ChunkData::updateSurface(int x, int z, int yMin, int yMax, int highest, BlockType highestType) {
+    int column = x + X_BOUND * z;
+    int top = m_surfaceHeight[column];
+    if(top > yMax) {
+        return;
+    }
+    if(highest != NO_SURFACE) {
+        m_surfaceHeight[column] = highest;
+        m_surfaceType[column] = highestType;
+        return;
+    }
+    if(top < yMin) {
+        return;
+    }
+
+    // The top block was cleared, so look further down the column,
+    // a whole section column at a time
+    int h = yMin - 1;
+    int bottom = sectionFloor(m_minSection);
+    while(h >= bottom) {
+        int s = sectionOf(h);
+        uint16_t rows = section(s).occupiedColumn(x, z) & rowRange(0, h - sectionFloor(s));
+        if(rows != 0) {
+            h = sectionFloor(s) + SECTION_HEIGHT - 1 - qCountLeadingZeroBits(rows);
+            break;
+        }
+        h = sectionFloor(s) - 1;
+    }
+    if(h < bottom) {
+        m_surfaceHeight[column] = NO_SURFACE;
+        m_surfaceType[column] = EMPTY;
+    } else {
+        m_surfaceHeight[column] = h;
+        m_surfaceType[column] = getBlockAt(x, h, z);
+    }
+}
+
+void ChunkData::fillColumn(int x, int z, int yMin, int yMax, BlockType t) {
+    fillBox(glm::ivec3(x, yMin, z), glm::ivec3(x, yMax, z), t);
+}
+
+void ChunkData::fillBox(glm::ivec3 min, glm::ivec3 max, BlockType t) {
+    min = glm::max(min, glm::ivec3(0, WORLD_MIN_Y, 0));
+    max = glm::min(max, glm::ivec3(X_BOUND - 1, WORLD_MAX_Y - 1, Z_BOUND - 1));
+    if(glm::any(glm::greaterThan(min, max))) {
+        return;
+    }
+    ensureThawed();
+    bool wholeLayers = min.x == 0 && min.z == 0 && max.x == X_BOUND - 1 && max.z == Z_BOUND - 1;
+    for(int s = sectionOf(min.y); s <= sectionOf(max.y); ++s) {
+        int i = s - m_minSection;
+        bool stored = i >= 0 && i < static_cast<int>(m_sections.size());
+        if(t == EMPTY && !stored) {
+            continue;
+        }
+        int lo = glm::max(min.y - sectionFloor(s), 0);
+        int hi = glm::min(max.y - sectionFloor(s), SECTION_HEIGHT - 1);
+        if(wholeLayers && lo == 0 && hi == SECTION_HEIGHT - 1) {
+            if(!stored) {
+                writableSection(s);
+            }
+            m_sections[s - m_minSection] = t == EMPTY ? emptySection() : std::make_shared<ChunkSection>(t);
+            continue;
+        }
+        ChunkSection &section = writableSection(s);
+        for(int x = min.x; x <= max.x; ++x) {
+            for(int z = min.z; z <= max.z; ++z) {
+                section.fillColumn(x, z, lo, hi, t);
+            }
+        }
+    }
+    ++m_version;
+    markDirty(min.y, max.y);
+    for(int x = min.x; x <= max.x; ++x) {
+        for(int z = min.z; z <= max.z; ++z) {
+            updateSurface(x, z, min.y, max.y, t == EMPTY ? NO_SURFACE : max.y, t);
+        }
+    }
+}
+
+void ChunkData::readSpan(int x, int z, int yMin, int yMax, BlockType *out) const {
+    if(x < 0 || x >= X_BOUND || z < 0 || z >= Z_BOUND) {
+        std::fill_n(out, glm::max(yMax - yMin + 1, 0), EMPTY);
+        return;
+    }
+    ensureThawed();
+    int y = yMin;
+    while(y <= yMax) {
+        if(y < WORLD_MIN_Y || y >= WORLD_MAX_Y) {
+            *out++ = EMPTY;
+            ++y;
+            continue;
+        }
+        int s = sectionOf(y);
+        int hi = glm::min(yMax, sectionFloor(s) + SECTION_HEIGHT - 1);
+        section(s).readColumn(x, z, y - sectionFloor(s), hi - sectionFloor(s), out);
+        out += hi - y + 1;
+        y = hi + 1;
+    }
+}
+
+void ChunkData::writeSpan(int x, int z, int yMin, int count, const BlockType *blocks) {
+    // Clip to the world's height
+    int first = glm::max(0, WORLD_MIN_Y - yMin);
+    int last = glm::min(count, WORLD_MAX_Y - yMin);
+    if(x < 0 || x >= X_BOUND || z < 0 || z >= Z_BOUND || first >= last) {
+        return;
+    }
+    ensureThawed();
+    int highest = NO_SURFACE;
+    BlockType highestType = EMPTY;
+    for(int i = first; i < last; ) {
+        int y = yMin + i;
+        int s = sectionOf(y);
+        int n = glm::min(last - i, sectionFloor(s) + SECTION_HEIGHT - y);
+        bool empty = true;
+        for(int k = i; k < i + n; ++k) {
+            if(blocks[k] != EMPTY) {
+                empty = false;
+                highest = yMin + k;
+                highestType = blocks[k];
+            }
+        }
+        int stored = s - m_minSection;
+        if(!empty || (stored >= 0 && stored < static_cast<int>(m_sections.size()))) {
+            ChunkSection &section = writableSection(s);
+            for(int k = 0; k < n; ++k) {
+                section.set(x, y - sectionFloor(s) + k, z, blocks[i + k]);
+            }
+        }
+        i += n;
+    }
+    ++m_version;
+    markDirty(yMin + first, yMin + last - 1);
+    updateSurface(x, z, yMin + first, yMin + last - 1, highest, highestType);
+}
+
+void ChunkData::copyRegion(const ChunkData &src, glm::ivec3 srcMin, glm::ivec3 srcMax, glm::ivec3 dstMin) {
+    glm::ivec3 size = srcMax - srcMin + 1;
+    if(glm::any(glm::lessThanEqual(size, glm::ivec3(0)))) {
+        return;
+    }
+    // Read everything first, in case src is this Chunk
+    std::vector<BlockType> blocks(size.x * size.y * size.z);
+    for(int x = 0; x < size.x; ++x) {
+        for(int z = 0; z < size.z; ++z) {
+            src.readSpan(srcMin.x + x, srcMin.z + z, srcMin.y, srcMax.y,
+                         &blocks[(x * size.z + z) * size.y]);
+        }
+    }
+    for(int x = 0; x < size.x; ++x) {
+        for(int z = 0; z < size.z; ++z) {
+            writeSpan(dstMin.x + x, dstMin.z + z, dstMin.y, size.y,
+                      &blocks[(x * size.z + z) * size.y]);
+        }
+    }
+}
+
+int ChunkData::getSurfaceHeight(unsigned int x, unsigned int z) const {
+    return m_surfaceHeight[x + X_BOUND * z];
+}
+
+BlockType ChunkData::getSurfaceBlock(unsigned int x, unsigned int z) const {
+    return m_surfaceType[x + X_BOUND * z];
+}
+
+void ChunkData::compactBlocks() {
+    ensureThawed();
+    for(size_t i = 0; i < m_sections.size(); ++i) {
+        if(m_sections[i] == emptySection()) {
+            continue;
+        }
+        ChunkSection &section = writableSection(m_minSection + i);
+        section.compact();
+        if(section.isUniform() && section.get(0, 0, 0) == EMPTY) {
+            m_sections[i] = emptySection();
+        }
+    }
+
+    trimSections();
+}
+
+void ChunkData::adoptSections(const ChunkData &src, int sMin, int sMax) {
+    sMin = glm::max(sMin, 0);
+    sMax = glm::min(sMax, SECTION_COUNT - 1);
+    if(sMin > sMax) {
+        return;
+    }
+    ensureThawed();
+    src.ensureThawed();
+    for(int s = sMin; s <= sMax; ++s) {
+        int i = s - m_minSection;
+        bool stored = i >= 0 && i < static_cast<int>(m_sections.size());
+        int j = s - src.m_minSection;
+        if((stored && m_sections[i] != emptySection()) ||
+           j < 0 || j >= static_cast<int>(src.m_sections.size()) ||
+           src.m_sections[j] == emptySection()) {
+            continue;
+        }
+        if(!stored) {
+            writableSection(s);
+        }
+        m_sections[s - m_minSection] = src.m_sections[j];
+    }
+    ++m_version;
+
+    int yMin = sectionFloor(sMin);
+    int yMax = sectionFloor(sMax) + SECTION_HEIGHT - 1;
+    markDirty(yMin, yMax);
+    for(int x = 0; x < X_BOUND; ++x) {
+        for(int z = 0; z < Z_BOUND; ++z) {
+            int highest = NO_SURFACE;
+            for(int s = sMax; s >= sMin && highest == NO_SURFACE; --s) {
+                uint16_t rows = section(s).occupiedColumn(x, z);
+                if(rows != 0) {
+                    highest = sectionFloor(s) + SECTION_HEIGHT - 1 - qCountLeadingZeroBits(rows);
+                }
+            }
+            updateSurface(x, z, yMin, yMax, highest,
+                          highest == NO_SURFACE ? EMPTY : getBlockAt(x, highest, z));
+        }
+    }
+}
+
+void ChunkData::clearSections(int sMin, int sMax) {
+    fillBox(glm::ivec3(0, sectionFloor(sMin), 0),
+            glm::ivec3(X_BOUND - 1, sectionFloor(sMax) + SECTION_HEIGHT - 1, Z_BOUND - 1), EMPTY);
+    trimSections();
+}
+
+void ChunkData::trimSections() {
+    // Air at either end of the stored range needn't be stored
+    while(!m_sections.empty() && m_sections.back() == emptySection()) {
+        m_sections.pop_back();
+    }
+    size_t first = 0;
+    while(first < m_sections.size() && m_sections[first] == emptySection()) {
+        ++first;
+    }
+    m_sections.erase(m_sections.begin(), m_sections.begin() + first);
+    m_minSection += first;
+    m_sections.shrink_to_fit();
+}
+
+const ChunkSection &ChunkData::section(int s) const {
+    int i = s - m_minSection;
+    if(i < 0 || i >= static_cast<int>(m_sections.size())) {
+        return *emptySection();
+    }
+    return *m_sections[i];
+}
+
+ChunkSection &ChunkData::writableSection(int s) {
+    if(m_sections.empty()) {
+        m_minSection = s;
+    } else if(s < m_minSection) {
+        m_sections.insert(m_sections.begin(), m_minSection - s, emptySection());
+        m_minSection = s;
+    }
+    int i = s - m_minSection;
+    if(i >= static_cast<int>(m_sections.size())) {
+        m_sections.resize(i + 1, emptySection());
+    }
+
+    // Only this Chunk's writer ever adds references to its sections,
+    // so a count of one can't change under us
+    std::shared_ptr<ChunkSection> &section = m_sections[i];
+    if(section.use_count() > 1) {
+        section = std::make_shared<ChunkSection>(*section);
+    }
+    return *section;
+}
+
+void ChunkData::publish() {
+    if(m_snapshot != nullptr && m_snapshot->version == m_version) {
+        return;
+    }
+    std::shared_ptr<ChunkSnapshot> snapshot = std::make_shared<ChunkSnapshot>();
+    snapshot->version = m_version;
+    snapshot->minSection = m_minSection;
+    snapshot->sections.assign(m_sections.begin(), m_sections.end());
+    snapshot->surfaceHeight = m_surfaceHeight;
+    std::atomic_store(&m_snapshot, std::shared_ptr<const ChunkSnapshot>(snapshot));
+}
+
+std::shared_ptr<const ChunkSnapshot> ChunkData::snapshot() const {
+    ensureThawed();
+    return std::atomic_load(&m_snapshot);
+}
+
+MeshInput ChunkData::meshInput() const {
+    MeshInput input;
+    input.center = snapshot();
+    for(int dir = 0; dir < 6; ++dir) {
+        if(m_neighbors[dir] != nullptr) {
+            input.neighbors[dir] = m_neighbors[dir]->snapshot();
+        }
+    }
+    return input;
+}
+
+uint64_t ChunkData::version() const {
+    return m_version;
+}
+
+const ChunkSection &ChunkSnapshot::section(int s) const {
+    int i = s - minSection;
+    if(i < 0 || i >= static_cast<int>(sections.size())) {
+        return *emptySection();
+    }
+    return *sections[i];
+}
+
+BlockType ChunkSnapshot::getBlockAt(int x, int y, int z) const {
+    if(y < WORLD_MIN_Y || y >= WORLD_MAX_Y) {
+        return EMPTY;
+    }
+    int s = sectionOf(y);
+    return section(s).get(x, y - sectionFloor(s), z);
+}
+
+
+// Indexed by Direction
+const static std::array<Direction, 6> oppositeDirection {
+    XNEG, XPOS, YNEG, YPOS, ZNEG, ZPOS
+};
+
+
+void ChunkData::linkNeighbor(uPtr<ChunkData> &neighbor, Direction dir) {
+    if(neighbor != nullptr) {
+        this->m_neighbors[dir] = neighbor.get();
+        neighbor->m_neighbors[oppositeDirection[dir]] = this;
+    }
+}
+
+void ChunkData::unlinkNeighbors() {
+    for(int dir = 0; dir < 6; ++dir) {
+        if(m_neighbors[dir] != nullptr) {
+            m_neighbors[dir]->m_neighbors[oppositeDirection[dir]] = nullptr;
+            m_neighbors[dir] = nullptr;
+        }
+    }
+}
+
+void ChunkData::markEdited() {
+    m_edited = true;
+}
+
+bool ChunkData::isEdited() const {
+    return m_edited;
+}
+
+bool ChunkData::isOpaqueAt(int x, int y, int z) const {
+    if(x < 0 || x >= X_BOUND || y < WORLD_MIN_Y || y >= WORLD_MAX_Y || z < 0 || z >= Z_BOUND) {
+        return false;
+    }
+    ensureThawed();
+    int s = sectionOf(y);
+    return (section(s).opaqueColumn(x, z) >> (y - sectionFloor(s))) & 1;
+}
+
+bool ChunkData::isOccupiedAt(int x, int y, int z) const {
+    if(x < 0 || x >= X_BOUND || y < WORLD_MIN_Y || y >= WORLD_MAX_Y || z < 0 || z >= Z_BOUND) {
+        return false;
+    }
+    ensureThawed();
+    int s = sectionOf(y);
+    return (section(s).occupiedColumn(x, z) >> (y - sectionFloor(s))) & 1;
+}
+
+bool ChunkData::isColumnSolid(int x, int z, int yMin, int yMax) const {
+    if(x < 0 || x >= X_BOUND || z < 0 || z >= Z_BOUND || yMin < WORLD_MIN_Y || yMax >= WORLD_MAX_Y) {
+        return false;
+    }
+    ensureThawed();
+    for(int s = sectionOf(yMin); s <= sectionOf(yMax); ++s) {
+        int lo = glm::max(yMin - sectionFloor(s), 0);
+        int hi = glm::min(yMax - sectionFloor(s), SECTION_HEIGHT - 1);
+        uint16_t rows = rowRange(lo, hi);
+        if((section(s).opaqueColumn(x, z) & rows) != rows) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ChunkData::anyOccupiedInBox(glm::ivec3 min, glm::ivec3 max) const {
+    // Only the stored sections can hold anything
+    int maxSection = m_minSection + static_cast<int>(m_sections.size());
+    min = glm::max(min, glm::ivec3(0, sectionFloor(m_minSection), 0));
+    max = glm::min(max, glm::ivec3(X_BOUND - 1, sectionFloor(maxSection) - 1, Z_BOUND - 1));
+    if(glm::any(glm::greaterThan(min, max))) {
+        return false;
+    }
+    ensureThawed();
+    for(int s = sectionOf(min.y); s <= sectionOf(max.y); ++s) {
+        const ChunkSection &section = this->section(s);
+        if(section.isUniform()) {
+            if(section.get(0, 0, 0) != EMPTY) {
+                return true;
+            }
+            continue;
+        }
+        int lo = glm::max(min.y - sectionFloor(s), 0);
+        int hi = glm::min(max.y - sectionFloor(s), SECTION_HEIGHT - 1);
+        uint64_t rows = rowRange(lo, hi);
+        // Each word covers four z's of one x, so test all of the box's
+        // z's that fall in the same word at once
+        for(int x = min.x; x <= max.x; ++x) {
+            for(int z = min.z; z <= max.z; z = (z | 3) + 1) {
+                uint64_t mask = 0;
+                for(int zi = z; zi <= glm::min(max.z, z | 3); ++zi) {
+                    mask |= rows << (SECTION_HEIGHT * (zi & 3));
+                }
+                int w = ChunkSection::maskBit(x, 0, z) >> 6;
+                if((section.opaqueWord(w) | section.transparentWord(w)) & mask) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void ChunkData::markDirty(int y) {
+    if(y < WORLD_MIN_Y || y >= WORLD_MAX_Y) {
+        return;
+    }
+    int s = sectionOf(y);
+    m_dirtySections.set(s);
+    if(y == sectionFloor(s) && s > 0) {
+        m_dirtySections.set(s - 1);
+    }
+    if(y == sectionFloor(s) + SECTION_HEIGHT - 1 && s < SECTION_COUNT - 1) {
+        m_dirtySections.set(s + 1);
+    }
+}
+
+void ChunkData::markDirty(int yMin, int yMax) {
+    yMin = glm::max(yMin, WORLD_MIN_Y);
+    yMax = glm::min(yMax, WORLD_MAX_Y - 1);
+    if(yMin > yMax) {
+        return;
+    }
+    for(int s = sectionOf(yMin); s <= sectionOf(yMax); ++s) {
+        m_dirtySections.set(s);
+    }
+    markDirty(yMin);
+    markDirty(yMax);
+}
+
+bool ChunkData::isDirty() const {
+    return m_dirtySections.any();
+}
+
+std::bitset<SECTION_COUNT> ChunkData::dirtySections() const {
+    return m_dirtySections;
+}
+
+void ChunkData::clearDirty() {
+    m_dirtySections.reset();
+}
+
+// Cold tier counters, shared by every Chunk
+static std::atomic<size_t> coldFrozenChunks(0);
+static std::atomic<size_t> coldRawBytes(0);
+static std::atomic<size_t> coldCompressedBytes(0);
+static std::atomic<size_t> coldThawCount(0);
+static std::atomic<uint64_t> coldThawNanos(0);
+static std::atomic<uint64_t> coldMaxThawNanos(0);
+
+float ColdTierStats::compressionRatio() const {
+    return compressedBytes == 0 ? 0.f : static_cast<float>(rawBytes) / compressedBytes;
+}
+
+float ColdTierStats::averageThawMs() const {
+    return thawCount == 0 ? 0.f : static_cast<float>(totalThawMs / thawCount);
+}
+
+ColdTierStats ChunkData::coldTierStats() {
+    ColdTierStats stats;
+    stats.frozenChunks = coldFrozenChunks;
+    stats.rawBytes = coldRawBytes;
+    stats.compressedBytes = coldCompressedBytes;
+    stats.thawCount = coldThawCount;
+    stats.totalThawMs = coldThawNanos * 1e-6;
+    stats.maxThawMs = coldMaxThawNanos * 1e-6;
+    return stats;
+}
+
+void ChunkData::ensureThawed() const {
+    if(m_frozen.load(std::memory_order_acquire)) {
+        // Thawing doesn't change what the Chunk holds, only how
+        const_cast<ChunkData*>(this)->thaw();
+    }
+}
+
+bool ChunkData::isFrozen() const {
+    return m_frozen.load(std::memory_order_acquire);
+}
+
+void ChunkData::freeze() {
+    QMutexLocker lock(&m_coldMutex);
+    if(m_frozen.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    std::vector<uint8_t> data;
+    size_t rawBytes = 0;
+    for(std::shared_ptr<ChunkSection> &sectionPtr : m_sections) {
+        const PaletteStorage &section = sectionPtr->blocks();
+        rawBytes += sectionPtr->memoryUsage();
+        unsigned int i = 0;
+        while(i < SECTION_VOLUME) {
+            BlockType t = section.get(i);
+            unsigned int run = 1;
+            if(section.isUniform()) {
+                run = SECTION_VOLUME;
+            } else {
+                while(i + run < SECTION_VOLUME && section.get(i + run) == t) {
+                    ++run;
+                }
+            }
+            data.push_back(t);
+            data.push_back(run & 0xff);
+            data.push_back(run >> 8);
+            i += run;
+        }
+        sectionPtr = emptySection();
+    }
+    data.shrink_to_fit();
+    m_coldData.swap(data);
+    m_coldRawBytes = rawBytes;
+    // The published snapshot would keep the sections alive
+    std::atomic_store(&m_snapshot, std::shared_ptr<const ChunkSnapshot>());
+
+    coldFrozenChunks++;
+    coldRawBytes += rawBytes;
+    coldCompressedBytes += m_coldData.size();
+    m_frozen.store(true, std::memory_order_release);
+}
+
+void ChunkData::thaw() {
+    QMutexLocker lock(&m_coldMutex);
+    if(!m_frozen.load(std::memory_order_relaxed)) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    size_t pos = 0;
+    for(std::shared_ptr<ChunkSection> &sectionPtr : m_sections) {
+        PaletteStorage section(SECTION_VOLUME, static_cast<BlockType>(m_coldData[pos]));
+        unsigned int i = 0;
+        while(i < SECTION_VOLUME) {
+            BlockType t = static_cast<BlockType>(m_coldData[pos]);
+            unsigned int run = m_coldData[pos + 1] | (m_coldData[pos + 2] << 8);
+            pos += 3;
+            if(i != 0) {
+                for(unsigned int end = i + run; i < end; ++i) {
+                    section.set(i, t);
+                }
+            } else {
+                i = run;
+            }
+        }
+        if(section.isUniform() && section.get(0) == EMPTY) {
+            sectionPtr = emptySection();
+        } else {
+            sectionPtr = std::make_shared<ChunkSection>(section);
+        }
+    }
+
+    coldFrozenChunks--;
+    coldRawBytes -= m_coldRawBytes;
+    coldCompressedBytes -= m_coldData.size();
+    std::vector<uint8_t>().swap(m_coldData);
+    m_coldRawBytes = 0;
+    ++m_version;
+    publish();
+    m_frozen.store(false, std::memory_order_release);
+
+    uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+    coldThawCount++;
+    coldThawNanos += nanos;
+    uint64_t slowest = coldMaxThawNanos;
+    while(nanos > slowest && !coldMaxThawNanos.compare_exchange_weak(slowest, nanos)) {}
+}
+
+int ChunkData::getWorldSpaceX() const {
+    return static_cast<int>(glm::floor(worldX / 16.f)) * 16; // Check
+}
+
+int ChunkData::getWorldSpaceZ() const {
+    return static_cast<int>(glm::floor(worldZ / 16.f)) * 16;
+}
+
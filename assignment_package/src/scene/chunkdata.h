@@ -0,0 +1,368 @@
+#pragma once
+#include "smartpointerhelp.h"
+#include "glm_includes.h"
+
+#include "chunkpool.h"
+#include "blockregistry.h"
+
+#include <QMutex>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#define X_BOUND 16
+#define Z_BOUND 16
+// Height of the band the terrain generators shape, from y = 0 up.
+// Everything below it is generated as stone.
+#define Y_BOUND 256
+
+// A Chunk's column can hold blocks anywhere from WORLD_MIN_Y up to (but
+// not including) WORLD_MAX_Y, and is split vertically into 16 x 16 x 16
+// sections, of which only those between the lowest and the highest
+// non-empty one are stored
+#define WORLD_MIN_Y -2048
+#define WORLD_MAX_Y 2048
+#define SECTION_HEIGHT 16
+#define SECTION_COUNT ((WORLD_MAX_Y - WORLD_MIN_Y) / SECTION_HEIGHT)
+#define SECTION_VOLUME (X_BOUND * SECTION_HEIGHT * Z_BOUND)
+
+// The surface height of a column that holds no blocks
+#define NO_SURFACE (WORLD_MIN_Y - 1)
+
+// Index, counted from the bottom of the world, of the section holding
+// blocks at height y, and the height of a section's lowest blocks
+inline int sectionOf(int y) {
+    return (y - WORLD_MIN_Y) / SECTION_HEIGHT;
+}
+inline int sectionFloor(int s) {
+    return WORLD_MIN_Y + s * SECTION_HEIGHT;
+}
+
+// for chunk create function helpers
+//#define CUB_IDX_COUNT 36;
+//#define CUB_VERT_COUNT 24;
+
+//using namespace std;
+
+enum Biomes : unsigned char
+{
+    DESERT, TUNDRA, GRASSLAND, MOUNTAIN
+};
+
+// Stores a fixed number of BlockTypes as indices into a palette of the
+// distinct types that actually occur, bit-packed into 64-bit words.
+// Most Chunks only contain a handful of block types, so each block needs
+// 1, 2 or 4 bits instead of a full byte. A storage holding a single type
+// keeps no index words at all. The index width is always a power of two
+// so that no index straddles two words, and it grows automatically when
+// a new type no longer fits in the palette.
+class PaletteStorage {
+private:
+    std::vector<BlockType> m_palette;
+    std::vector<uint64_t, PoolAllocator<uint64_t>> m_words;
+    unsigned int m_bits; // Bits per palette index: 0, 1, 2, 4 or 8
+    unsigned int m_size;
+
+    unsigned int paletteIndex(unsigned int i) const;
+    void setPaletteIndex(unsigned int i, unsigned int p);
+    // Repacks every index using the given number of bits
+    void resize(unsigned int bits);
+    // The palette index of t, adding it to the palette if needed
+    unsigned int paletteSlot(BlockType t);
+
+public:
+    PaletteStorage(unsigned int size = SECTION_VOLUME, BlockType fill = EMPTY);
+
+    BlockType get(unsigned int i) const;
+    void set(unsigned int i, BlockType t);
+    // Sets, or copies out, count consecutive blocks starting at first.
+    // fill writes whole words at a time.
+    void fill(unsigned int first, unsigned int count, BlockType t);
+    void read(unsigned int first, unsigned int count, BlockType *out) const;
+
+    // True if every stored block has the same type, in which case
+    // no index words are kept and get() always returns that type
+    bool isUniform() const;
+
+    // Drops palette entries that are no longer referenced by any block
+    // and shrinks the index width to match
+    void compact();
+
+    unsigned int paletteSize() const;
+    // Every type that may occur, and possibly some that no longer do
+    const std::vector<BlockType> &palette() const;
+    // Number of bytes used by the palette and the packed indices
+    size_t memoryUsage() const;
+};
+
+// One 16 x 16 x 16 section of a Chunk: its blocks, plus one bit per
+// block saying whether it is opaque and one saying whether it is
+// transparent. The masks answer "is this cell solid?" without decoding
+// the palette, and let row, column and box queries test up to 64
+// blocks per word.
+// Bit maskBit(x, y, z) belongs to block x, y, z, so each word holds the
+// 16-block columns at one x and four consecutive z.
+class ChunkSection {
+private:
+    PaletteStorage m_blocks;
+    // MASK_WORDS opaque words followed by MASK_WORDS transparent ones.
+    // Left empty while the section holds a single block type, whose
+    // masks are all ones or all zeros.
+    std::vector<uint64_t, PoolAllocator<uint64_t>> m_masks;
+
+    void buildMasks();
+
+public:
+    static const int MASK_WORDS = SECTION_VOLUME / 64;
+
+    static int maskBit(int x, int y, int z) {
+        return y + SECTION_HEIGHT * (z + Z_BOUND * x);
+    }
+
+    explicit ChunkSection(BlockType fill = EMPTY);
+    explicit ChunkSection(const PaletteStorage &blocks);
+
+    // x, y and z are local to the section
+    BlockType get(int x, int y, int z) const;
+    void set(int x, int y, int z, BlockType t);
+    // Sets, or copies out, blocks yMin to yMax (inclusive) of column x, z
+    void fillColumn(int x, int z, int yMin, int yMax, BlockType t);
+    void readColumn(int x, int z, int yMin, int yMax, BlockType *out) const;
+
+    const PaletteStorage &blocks() const;
+    bool isUniform() const;
+    void compact();
+    size_t memoryUsage() const;
+
+    uint64_t opaqueWord(int w) const;
+    uint64_t transparentWord(int w) const;
+    // Bit y is set if block x, y, z is opaque / is not EMPTY
+    uint16_t opaqueColumn(int x, int z) const;
+    uint16_t occupiedColumn(int x, int z) const;
+};
+
+// An immutable copy of a Chunk's blocks as of one version, which worker
+// threads can read without locks while the game thread keeps editing
+// the Chunk. Sections are shared with the Chunk and with older
+// snapshots until the Chunk next writes to them (see
+// ChunkData::writableSection), so publishing one only copies pointers and
+// the heightmap.
+struct ChunkSnapshot {
+    uint64_t version;
+    // The Chunk's stored sections, the first of which is section
+    // minSection. Every other section is air.
+    int minSection;
+    std::vector<std::shared_ptr<const ChunkSection>> sections;
+    std::array<short, X_BOUND * Z_BOUND> surfaceHeight;
+
+    // The given section, or an all-air one if it is not stored
+    const ChunkSection &section(int s) const;
+    BlockType getBlockAt(int x, int y, int z) const;
+    int getSurfaceHeight(int x, int z) const {
+        return surfaceHeight[x + X_BOUND * z];
+    }
+};
+
+// Everything the mesher reads: a snapshot of the Chunk being meshed
+// and of each of its horizontal neighbours (indexed by Direction,
+// null where there is no neighbour)
+struct MeshInput {
+    std::shared_ptr<const ChunkSnapshot> center;
+    std::array<std::shared_ptr<const ChunkSnapshot>, 6> neighbors;
+};
+
+// Counters describing the compressed cold tier (see ChunkData::freeze),
+// summed over every Chunk
+struct ColdTierStats {
+    size_t frozenChunks;     // Chunks currently compressed
+    size_t rawBytes;         // Bytes their sections used before compression
+    size_t compressedBytes;  // Bytes their run-length encoding uses
+    size_t thawCount;        // Chunks decompressed so far
+    double totalThawMs;      // Time spent decompressing them
+    double maxThawMs;        // Slowest single decompression
+
+    // rawBytes / compressedBytes, or 0 while nothing is compressed
+    float compressionRatio() const;
+    float averageThawMs() const;
+};
+
+// One Chunk is a 16 x 16 column of the world, stretching from
+// WORLD_MIN_Y to WORLD_MAX_Y, containing all the Minecraft blocks in
+// that area.
+// We divide the world into Chunks in order to make
+// recomputing its VBO data faster by not having to
+// render all the world at once, while also not having
+// to render the world block by block.
+// ChunkData holds only a Chunk's blocks and needs neither Qt GUI nor
+// OpenGL, so terrain can be generated headlessly. The GPU side of a
+// Chunk is a separate ChunkMesh, which only Chunks near the Player have.
+
+class ChunkData {
+private:
+    // All of the blocks contained within this Chunk, stored as vertical
+    // 16 x 16 x 16 sections from bottom to top. Only the sections from
+    // m_minSection up to the highest one that was written to are kept;
+    // all others are air and cost nothing.
+    // Sections that hold a single block type (usually air above the
+    // surface or stone below it) store that one value and no array,
+    // and all-air sections share one storage between every Chunk.
+    // A section may also be shared with published snapshots, so it is
+    // only ever written through writableSection.
+    std::vector<std::shared_ptr<ChunkSection>> m_sections;
+    int m_minSection;
+    // For every x, z column, the y of its highest non-empty block
+    // (NO_SURFACE for an empty column) and that block's type.
+    // Kept up to date by setBlockAt so surface queries never have to
+    // scan the column.
+    std::array<short, X_BOUND * Z_BOUND> m_surfaceHeight;
+    std::array<BlockType, X_BOUND * Z_BOUND> m_surfaceType;
+    // This Chunk's four neighbors to the north, south, east, and west,
+    // indexed by Direction. The YPOS and YNEG entries are always null.
+    std::array<ChunkData*, 6> m_neighbors;
+
+    // Milestone 2 changes
+    float worldX;
+    float worldZ;
+
+    // Set once the player has changed a block in this Chunk, so that
+    // Terrain hands it to its persistence hook instead of discarding it
+    bool m_edited;
+    // One bit per section whose blocks changed since the Chunk's mesh
+    // was last built
+    std::bitset<SECTION_COUNT> m_dirtySections;
+
+    // Compressed cold tier. While frozen, m_sections are all empty and
+    // the blocks live in m_coldData as runs of (type, 16-bit length) in
+    // storage order, section by section.
+    std::atomic<bool> m_frozen;
+    QMutex m_coldMutex;
+    std::vector<uint8_t> m_coldData;
+    size_t m_coldRawBytes;
+
+    // Incremented by every block write. m_snapshot is the latest
+    // published copy of the blocks. freeze() drops it so that it doesn't
+    // keep the sections alive, and thaw() publishes a new one, so
+    // snapshot() (which thaws first) never returns null.
+    uint64_t m_version;
+    std::shared_ptr<const ChunkSnapshot> m_snapshot;
+
+    // The given section, or an all-air one if it is not stored
+    const ChunkSection &section(int s) const;
+    // The given section, first copied if any snapshot still shares it.
+    // Sections outside the stored range are added as air.
+    ChunkSection &writableSection(int s);
+
+    // Decompresses the Chunk if it is frozen. Reading a frozen Chunk
+    // thaws it, so every accessor of m_sections calls this first.
+    void ensureThawed() const;
+
+    // Drops all-air sections from the ends of the stored range
+    void trimSections();
+
+    // Brings the heightmap of column x, z up to date after blocks yMin
+    // to yMax were written, the highest non-empty one of which is at
+    // height highest (NO_SURFACE if they are all EMPTY)
+    void updateSurface(int x, int z, int yMin, int yMax, int highest, BlockType highestType);
+
+public:
+
+    ChunkData(float x, float z);
+
+    // Chunks are carved out of the ChunkPool's slabs rather than
+    // allocated individually on the heap
+    static void *operator new(size_t bytes);
+    static void operator delete(void *p, size_t bytes);
+
+    // x and z are Chunk-local, y is a world height and may be negative
+    BlockType getBlockAt(unsigned int x, int y, unsigned int z) const;
+
+    BlockType getBlockAt(int x, int y, int z) const;
+
+    void setBlockAt(unsigned int x, int y, unsigned int z, BlockType t);
+    // y of the highest non-empty block in the column, or NO_SURFACE if empty
+    int getSurfaceHeight(unsigned int x, unsigned int z) const;
+    BlockType getSurfaceBlock(unsigned int x, unsigned int z) const;
+
+    // Occupancy queries answered from the sections' bit masks. All
+    // coordinates are Chunk-local; anything outside the Chunk is empty.
+    bool isOpaqueAt(int x, int y, int z) const;
+    bool isOccupiedAt(int x, int y, int z) const;
+    // Is every block of column x, z from yMin to yMax (inclusive) opaque?
+    bool isColumnSolid(int x, int z, int yMin, int yMax) const;
+    // Is any block in the inclusive box from min to max not EMPTY?
+    bool anyOccupiedInBox(glm::ivec3 min, glm::ivec3 max) const;
+
+    // Bulk access. These work on whole runs of blocks at once instead of
+    // going through setBlockAt block by block, and clip to the Chunk and
+    // the world's height instead of throwing. All bounds are inclusive
+    // and Chunk-local.
+    // Sets column x, z from yMin to yMax to t
+    void fillColumn(int x, int z, int yMin, int yMax, BlockType t);
+    // Sets the box from min to max to t. Sections it covers entirely are
+    // replaced by a single-type section without touching their blocks.
+    void fillBox(glm::ivec3 min, glm::ivec3 max, BlockType t);
+    // Copies blocks yMin to yMax of column x, z into out, which must have
+    // room for yMax - yMin + 1 blocks
+    void readSpan(int x, int z, int yMin, int yMax, BlockType *out) const;
+    // Writes count blocks to column x, z, the first at height yMin
+    void writeSpan(int x, int z, int yMin, int count, const BlockType *blocks);
+    // Copies the box from srcMin to srcMax of src into this Chunk so that
+    // srcMin lands on dstMin. src may be this Chunk, and the boxes may
+    // overlap.
+    void copyRegion(const ChunkData &src, glm::ivec3 srcMin, glm::ivec3 srcMax, glm::ivec3 dstMin);
+
+    // Shrinks the block palettes once generation has finished writing,
+    // collapsing sections that ended up holding a single block type and
+    // dropping all-air sections from the ends of the stored range
+    void compactBlocks();
+    // Takes over src's sections sMin to sMax, sharing their storage, so
+    // src must not be written to afterwards. Sections this Chunk already
+    // holds blocks in are kept as they are.
+    void adoptSections(const ChunkData &src, int sMin, int sMax);
+    // Empties sections sMin to sMax, which stop being stored once they
+    // reach either end of the stored range
+    void clearSections(int sMin, int sMax);
+    void linkNeighbor(uPtr<ChunkData>& neighbor, Direction dir);
+    // Undoes linkNeighbor for every neighbour of this Chunk, so that
+    // none of them keeps a pointer to it
+    void unlinkNeighbors();
+
+    void markEdited();
+    bool isEdited() const;
+
+    // Records that the block at height y changed. A change on a section
+    // boundary also changes the faces of the section next to it.
+    void markDirty(int y);
+    // Records that blocks yMin to yMax changed
+    void markDirty(int yMin, int yMax);
+    bool isDirty() const;
+    std::bitset<SECTION_COUNT> dirtySections() const;
+    // Called once a mesh of the current blocks has been requested
+    void clearDirty();
+
+    // Makes the Chunk's current blocks visible to snapshot(). Only the
+    // thread that writes the Chunk's blocks may call this, once it has
+    // finished a batch of writes (generation, or a player edit).
+    void publish();
+    // The most recently published blocks. Safe to call from any thread.
+    std::shared_ptr<const ChunkSnapshot> snapshot() const;
+    // Snapshots of this Chunk and its neighbours for the mesher
+    MeshInput meshInput() const;
+    uint64_t version() const;
+
+    // Run-length encodes every section and releases their storage.
+    // The Chunk stays usable: the next read or write through any of its
+    // accessors thaws it again. Must not be called while another thread
+    // may be reading the Chunk.
+    void freeze();
+    void thaw();
+    bool isFrozen() const;
+    static ColdTierStats coldTierStats();
+
+    int getWorldSpaceX() const;
+    int getWorldSpaceZ() const;
+};
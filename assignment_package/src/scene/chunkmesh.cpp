@@ -0,0 +1,659 @@
+#include "chunkmesh.h"
+#include "chunktree.h"
+#include "facecull.h"
+#include <QtAlgorithms>
+#include <algorithm>
+
+ChunkMesh::ChunkMesh(OpenGLContext *context, ChunkData *chunk, MeshMode mode) :
+    Drawable(context), mp_chunk(chunk), m_transCount(-1), m_mode(mode),
+    m_layout(), m_transLayout(), m_faceTex(), m_transFaceTex(), m_faceTexGenerated(false)
+{}
+
+void ChunkMesh::destroy() {
+    Drawable::destroy();
+    if(m_faceTexGenerated) {
+        mp_context->glDeleteTextures(1, &m_faceTex);
+        mp_context->glDeleteTextures(1, &m_transFaceTex);
+        m_faceTexGenerated = false;
+    }
+    m_transCount = -1;
+    m_layout = FaceLayout();
+    m_transLayout = FaceLayout();
+}
+
+int ChunkMesh::transElemCount() {
+    return m_transCount;
+}
+
+const std::vector<FaceRange> &ChunkMesh::faceRanges() const {
+    return m_layout.ranges;
+}
+
+const std::vector<FaceRange> &ChunkMesh::transFaceRanges() const {
+    return m_transLayout.ranges;
+}
+
+void ChunkMesh::faceRanges(int minSection, int maxSection, std::vector<FaceRange> *out) const {
+    collectRanges(m_layout, minSection, maxSection, out);
+}
+
+void ChunkMesh::transFaceRanges(int minSection, int maxSection, std::vector<FaceRange> *out) const {
+    collectRanges(m_transLayout, minSection, maxSection, out);
+}
+
+void ChunkMesh::setMode(MeshMode mode) {
+    m_mode = mode;
+}
+
+QuadIndices::QuadIndices(OpenGLContext *context) : Drawable(context)
+{}
+
+void QuadIndices::create() {
+    std::vector<GLushort> idx;
+    idx.reserve(QUAD_COUNT * 6);
+    for(int q = 0; q < QUAD_COUNT; ++q) {
+        GLushort first = 4 * q;
+        idx.insert(idx.end(), {first, GLushort(first + 1), GLushort(first + 2),
+                               first, GLushort(first + 2), GLushort(first + 3)});
+    }
+    m_count = idx.size();
+
+    generateIdx();
+    mp_context->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_bufIdx);
+    mp_context->glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                             idx.size() * sizeof(GLushort),
+                             idx.data(),
+                             GL_STATIC_DRAW);
+}
+
+void MeshBuffers::clear() {
+    faces.clear();
+    transFaces.clear();
+    meshedSections.set();
+}
+
+size_t MeshBuffers::capacityBytes() const {
+    return (faces.capacity() + transFaces.capacity()) * sizeof(ChunkFace) +
+           faceCells.capacity() * sizeof(BlockType);
+}
+
+// Transparent faces go in their own buffer. The fragment shader works
+// out where in the face's atlas tile each fragment falls from its
+// position.
+void MeshBuffers::addFace(Direction dir, BlockType type, glm::ivec3 pos, glm::ivec3 size) {
+    const BlockInfo &info = blockInfo(type);
+    std::vector<ChunkFace> &out = info.transparent ? transFaces : faces;
+    out.emplace_back(pos, size, dir | (info.animated << 3) | (info.tiles[dir] << 4));
+}
+
+
+void ChunkMesh::create(){
+    MeshBuffers mesh;
+    MeshInput input = mp_chunk->meshInput();
+    mp_chunk->clearDirty();
+    createChunk(input, &mesh, m_mode);
+    createCubeVBO(mesh);
+}
+
+// Where a face of the block at x, y, z (local to its section) goes among
+// a section's GREEDY face cells: the slice along the face's normal, and
+// the cell within the slice. Cells are indexed [a][b].
+static int faceCell(Direction dir, int x, int y, int z) {
+    int slice, a, b;
+    if(dir == XPOS || dir == XNEG) {
+        slice = x; a = z; b = y;
+    } else if(dir == YPOS || dir == YNEG) {
+        slice = y; a = x; b = z;
+    } else {
+        slice = z; a = x; b = y;
+    }
+    return ((dir * SECTION_HEIGHT + slice) * SECTION_HEIGHT + a) * SECTION_HEIGHT + b;
+}
+
+// Position and size of the rectangle of w by h cells starting at cell
+// a, b of the given slice
+static void cellRect(Direction dir, int slice, int a, int b, int w, int h, int sectionY,
+                     glm::ivec3 *pos, glm::ivec3 *size) {
+    if(dir == XPOS || dir == XNEG) {
+        *pos = glm::ivec3(slice, sectionY + b, a);
+        *size = glm::ivec3(1, h, w);
+    } else if(dir == YPOS || dir == YNEG) {
+        *pos = glm::ivec3(a, sectionY + slice, b);
+        *size = glm::ivec3(w, 1, h);
+    } else {
+        *pos = glm::ivec3(a, sectionY + b, slice);
+        *size = glm::ivec3(w, h, 1);
+    }
+}
+
+// Merges the faces in one slice of n by n face cells, indexed [a][b]
+// with EMPTY where there is no face, into rectangles of a single block
+// type, calling emit(a, b, w, h, type) for each, and leaves the cells
+// empty again. Each rectangle is grown along b as far as it goes, then
+// along a for as long as the whole run matches.
+template<typename Emit>
+static void mergeSlice(BlockType *cells, int n, Emit emit) {
+    for(int a = 0; a < n; ++a) {
+        int b = 0;
+        while(b < n) {
+            BlockType t = cells[a * n + b];
+            if(t == EMPTY) {
+                ++b;
+                continue;
+            }
+            int h = 1;
+            while(b + h < n && cells[a * n + b + h] == t) {
+                ++h;
+            }
+            int w = 1;
+            while(a + w < n &&
+                  std::all_of(cells + (a + w) * n + b, cells + (a + w) * n + b + h,
+                              [t](BlockType c) { return c == t; })) {
+                ++w;
+            }
+            for(int i = a; i < a + w; ++i) {
+                std::fill_n(cells + i * n + b, h, EMPTY);
+            }
+            emit(a, b, w, h, t);
+            b += h;
+        }
+    }
+}
+
+// Merges the faces collected in the section's face cells and adds each
+// rectangle to out
+static void mergeFaces(MeshBuffers *out, std::bitset<6 * SECTION_HEIGHT> *usedSlices, int sectionY) {
+    const int n = SECTION_HEIGHT;
+    for(int d = 0; d < 6; ++d) {
+        Direction dir = static_cast<Direction>(d);
+        for(int slice = 0; slice < n; ++slice) {
+            if(!usedSlices->test(d * n + slice)) {
+                continue;
+            }
+            mergeSlice(&out->faceCells[(d * n + slice) * n * n], n,
+                       [&](int a, int b, int w, int h, BlockType t) {
+                glm::ivec3 pos, size;
+                cellRect(dir, slice, a, b, w, h, sectionY, &pos, &size);
+                out->addFace(dir, t, pos, size);
+            });
+        }
+    }
+    usedSlices->reset();
+}
+
+void ChunkMesh::createChunk(const MeshInput &input, MeshBuffers *out, MeshMode mode,
+                            const std::bitset<SECTION_COUNT> *sections){
+    out->clear();
+    if(sections != nullptr) {
+        out->meshedSections = *sections;
+    }
+
+    // In GREEDY mode a section's visible faces are first collected in
+    // out->faceCells (see faceCell), with EMPTY where there is none, and
+    // merged once the whole section has been visited. Merging leaves the
+    // cells EMPTY again, so recycled buffers only set them up once. Bit
+    // d * 16 + slice of usedSlices is set for every slice holding a face.
+    std::bitset<6 * SECTION_HEIGHT> usedSlices;
+    if(mode == GREEDY && out->faceCells.size() != 6 * SECTION_VOLUME) {
+        out->faceCells.assign(6 * SECTION_VOLUME, EMPTY);
+    }
+
+    // Adds every face set in faces to out, or to its face cells in
+    // GREEDY mode. The faces are all of the given type, or if that is
+    // EMPTY, each one's type is read from the section.
+    auto emitFaces = [&](const std::array<SectionMask, 6> &faces, const ChunkSection &section,
+                         int sectionY, BlockType type) {
+        for(int d = 0; d < 6; ++d) {
+            Direction dir = static_cast<Direction>(d);
+            for(int x = 0; x < X_BOUND; ++x) {
+                for(int g = 0; g < 4; ++g) {
+                    uint64_t word = faces[d].rows[x][g];
+                    while(word != 0) {
+                        int i = qCountTrailingZeroBits(word);
+                        word &= word - 1;
+                        int y = i & (SECTION_HEIGHT - 1);
+                        int z = 4 * g + (i >> 4);
+                        BlockType bt = type != EMPTY ? type : section.get(x, y, z);
+                        if(mode == GREEDY) {
+                            int cell = faceCell(dir, x, y, z);
+                            out->faceCells[cell] = bt;
+                            usedSlices.set(cell / (SECTION_HEIGHT * SECTION_HEIGHT));
+                        } else {
+                            out->addFace(dir, bt, glm::ivec3(x, sectionY + y, z), glm::ivec3(1));
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    // A face is visible if the block it looks at is EMPTY, or is
+    // transparent and of a different type (see isTransparent). So opaque
+    // blocks are hidden by opaque ones, and each transparent type by
+    // opaque blocks and by itself.
+    SectionMask material;
+    BorderedMask blockers;
+    std::array<SectionMask, 6> faces;
+    std::vector<BlockType> transparentTypes;
+
+    const ChunkSnapshot &center = *input.center;
+    for(int i = 0; i < static_cast<int>(center.sections.size()); ++i){
+        const ChunkSection &section = *center.sections[i];
+        int s = center.minSection + i;
+        int sectionY = sectionFloor(s);
+        // Sections of pure air have no faces at all
+        if (section.isUniform() && section.get(0, 0, 0) == BlockType::EMPTY) {
+            continue;
+        }
+        if(!out->meshedSections.test(s)) {
+            continue;
+        }
+
+        buildBorderedMask(input, s, MaskKind::OPAQUE, EMPTY, &blockers);
+        std::copy(&blockers.rows[1][0], &blockers.rows[X_BOUND + 1][0], &material.rows[0][0]);
+        cullFaces(material, blockers, &faces);
+        emitFaces(faces, section, sectionY, EMPTY);
+
+        // Every transparent type that the section's blocks, or their
+        // neighbours, might be
+        transparentTypes.clear();
+        auto addTypes = [&](const ChunkSection &other) {
+            for(BlockType t : other.blocks().palette()) {
+                if(isTransparent(t) && std::find(transparentTypes.begin(), transparentTypes.end(), t) == transparentTypes.end()) {
+                    transparentTypes.push_back(t);
+                }
+            }
+        };
+        addTypes(section);
+        if(!transparentTypes.empty()) {
+            addTypes(center.section(s - 1));
+            addTypes(center.section(s + 1));
+            for(Direction d : {XPOS, XNEG, ZPOS, ZNEG}) {
+                if(input.neighbors[d]) {
+                    addTypes(input.neighbors[d]->section(s));
+                }
+            }
+        }
+
+        if(transparentTypes.size() == 1) {
+            // With a single transparent type around, the section's
+            // masks already single it out
+            buildMask(center, s, MaskKind::TRANSPARENT, EMPTY, &material);
+            buildBorderedMask(input, s, MaskKind::OCCUPIED, EMPTY, &blockers);
+            cullFaces(material, blockers, &faces);
+            emitFaces(faces, section, sectionY, transparentTypes[0]);
+        } else {
+            for(BlockType t : transparentTypes) {
+                buildMask(center, s, MaskKind::TYPE, t, &material);
+                buildBorderedMask(input, s, MaskKind::OPAQUE_OR_TYPE, t, &blockers);
+                cullFaces(material, blockers, &faces);
+                emitFaces(faces, section, sectionY, t);
+            }
+        }
+
+        if(mode == GREEDY) {
+            mergeFaces(out, &usedSlices, sectionY);
+        }
+    }
+}
+
+
+// Sets the type of each cell of a section in cells (x + n * (z + n * y),
+// n cells to a side), EMPTY where the cell holds no blocks.
+// readColumn(x, z, out) gives the section's 16 blocks at x, z, lowest
+// first. counts and countedLayer are scratch space.
+template<typename ReadColumn>
+static void sampleLodSection(ReadColumn readColumn, int cellSize, LodSampling sampling,
+                             std::vector<uint16_t> *counts, std::vector<int8_t> *countedLayer,
+                             BlockType *cells) {
+    const int n = SECTION_HEIGHT / cellSize;
+    const int perSection = n * n * n;
+    // How many blocks of each type each cell holds, and for TOP_SURFACE
+    // the height within the cell of the layer counted
+    counts->assign(perSection * BLOCK_TYPE_COUNT, 0);
+    countedLayer->assign(perSection, -1);
+    std::array<BlockType, SECTION_HEIGHT> column;
+    for(int x = 0; x < X_BOUND; ++x) {
+        for(int z = 0; z < Z_BOUND; ++z) {
+            readColumn(x, z, column.data());
+            for(int y = 0; y < SECTION_HEIGHT; ++y) {
+                BlockType t = column[y];
+                if(t == EMPTY) {
+                    continue;
+                }
+                int c = x / cellSize + n * (z / cellSize + n * (y / cellSize));
+                if(sampling == TOP_SURFACE) {
+                    // Only the highest layer of the cell holding any
+                    // block counts
+                    int layer = y % cellSize;
+                    if(layer < (*countedLayer)[c]) {
+                        continue;
+                    }
+                    if(layer > (*countedLayer)[c]) {
+                        std::fill_n(&(*counts)[c * BLOCK_TYPE_COUNT], BLOCK_TYPE_COUNT, 0);
+                        (*countedLayer)[c] = layer;
+                    }
+                }
+                (*counts)[c * BLOCK_TYPE_COUNT + t]++;
+            }
+        }
+    }
+    for(int c = 0; c < perSection; ++c) {
+        const uint16_t *cellCounts = &(*counts)[c * BLOCK_TYPE_COUNT];
+        const uint16_t *best = std::max_element(cellCounts + 1, cellCounts + BLOCK_TYPE_COUNT);
+        cells[c] = *best == 0 ? EMPTY : static_cast<BlockType>(best - cellCounts);
+    }
+}
+
+// Adds the faces of a level of detail to out, given the type of every
+// cell of its stored sections (see sampleLodSection), the lowest of
+// which is minSection. Anything outside them is EMPTY.
+static void emitLodFaces(const std::vector<BlockType> &cells, int minSection, int level,
+                         MeshBuffers *out) {
+    const int cellSize = 1 << level;
+    const int n = SECTION_HEIGHT / cellSize;
+    const int perSection = n * n * n;
+    const int sectionCount = cells.size() / perSection;
+    auto cellAt = [&](int x, int y, int z) {
+        if(x < 0 || x >= n || z < 0 || z >= n || y < 0 || y >= sectionCount * n) {
+            return EMPTY;
+        }
+        return cells[x + n * (z + n * y)];
+    };
+
+    // The highest cell of each column holding any block, or -1. Faces
+    // on the Chunk's sides are only kept for the cells within
+    // LOD_SKIRT_DEPTH blocks of it, and the rest count as hidden by the
+    // neighbouring Chunk.
+    std::array<int, SECTION_HEIGHT * SECTION_HEIGHT> columnTop;
+    columnTop.fill(-1);
+    for(int x = 0; x < n; ++x) {
+        for(int z = 0; z < n; ++z) {
+            for(int y = sectionCount * n - 1; y >= 0; --y) {
+                if(cellAt(x, y, z) != EMPTY) {
+                    columnTop[x * n + z] = y;
+                    break;
+                }
+            }
+        }
+    }
+    const int skirtCells = (LOD_SKIRT_DEPTH + cellSize - 1) / cellSize;
+
+    // Faces are visible by the same rule as in createChunk, with cells
+    // in place of blocks. Each slice's faces are merged like GREEDY's,
+    // section by section, so that no face is more than 16 blocks across.
+    std::array<BlockType, SECTION_HEIGHT * SECTION_HEIGHT> faceCells;
+    for(int i = 0; i < sectionCount; ++i) {
+        auto first = cells.begin() + i * perSection;
+        if(std::all_of(first, first + perSection, [](BlockType t) { return t == EMPTY; })) {
+            continue;
+        }
+        int sectionY = sectionFloor(minSection + i);
+        for(int d = 0; d < 6; ++d) {
+            Direction dir = static_cast<Direction>(d);
+            glm::ivec3 step = directionVecs[d];
+            for(int slice = 0; slice < n; ++slice) {
+                bool any = false;
+                for(int a = 0; a < n; ++a) {
+                    for(int b = 0; b < n; ++b) {
+                        glm::ivec3 cell, unused;
+                        cellRect(dir, slice, a, b, 1, 1, i * n, &cell, &unused);
+                        BlockType t = cellAt(cell.x, cell.y, cell.z);
+                        glm::ivec3 ahead = cell + step;
+                        BlockType next = cellAt(ahead.x, ahead.y, ahead.z);
+                        bool visible = t != EMPTY && (next == EMPTY || (isTransparent(next) && next != t));
+                        if(visible && (ahead.x < 0 || ahead.x >= n || ahead.z < 0 || ahead.z >= n)) {
+                            visible = cell.y > columnTop[cell.x * n + cell.z] - skirtCells;
+                        }
+                        faceCells[a * n + b] = visible ? t : EMPTY;
+                        any = any || visible;
+                    }
+                }
+                if(!any) {
+                    continue;
+                }
+                mergeSlice(faceCells.data(), n, [&](int a, int b, int w, int h, BlockType t) {
+                    glm::ivec3 pos, size;
+                    cellRect(dir, slice, a, b, w, h, 0, &pos, &size);
+                    out->addFace(dir, t, pos * cellSize + glm::ivec3(0, sectionY, 0),
+                                 size * cellSize);
+                });
+            }
+        }
+    }
+}
+
+void ChunkMesh::createLodChunk(const ChunkSnapshot &chunk, int level,
+                               LodSampling sampling, MeshBuffers *out) {
+    out->clear();
+    const int cellSize = 1 << level;
+    const int n = SECTION_HEIGHT / cellSize;
+    const int perSection = n * n * n;
+
+    std::vector<BlockType> cells(chunk.sections.size() * perSection, EMPTY);
+    std::vector<uint16_t> counts;
+    std::vector<int8_t> countedLayer;
+    for(size_t i = 0; i < chunk.sections.size(); ++i) {
+        const ChunkSection &section = *chunk.sections[i];
+        BlockType *sectionCells = &cells[i * perSection];
+        if(section.isUniform()) {
+            std::fill_n(sectionCells, perSection, section.get(0, 0, 0));
+            continue;
+        }
+        sampleLodSection([&](int x, int z, BlockType *column) {
+            section.readColumn(x, z, 0, SECTION_HEIGHT - 1, column);
+        }, cellSize, sampling, &counts, &countedLayer, sectionCells);
+    }
+    emitLodFaces(cells, chunk.minSection, level, out);
+}
+
+void ChunkMesh::createLodChunk(const ChunkTree &chunk, int level,
+                               LodSampling sampling, MeshBuffers *out) {
+    out->clear();
+    const int cellSize = 1 << level;
+    const int n = SECTION_HEIGHT / cellSize;
+    const int perSection = n * n * n;
+
+    // The tree knows exactly which blocks are occupied, but only each
+    // brick's most common type, so every block reads as its brick's
+    std::vector<BlockType> cells(chunk.sectionCount() * perSection, EMPTY);
+    std::vector<uint16_t> counts;
+    std::vector<int8_t> countedLayer;
+    for(int i = 0; i < chunk.sectionCount(); ++i) {
+        int sectionY = sectionFloor(chunk.minSection() + i);
+        if(!chunk.isSectionOccupied(sectionY)) {
+            continue;
+        }
+        sampleLodSection([&](int x, int z, BlockType *column) {
+            for(int y = 0; y < SECTION_HEIGHT; ++y) {
+                column[y] = chunk.isOccupiedAt(x, sectionY + y, z) ?
+                            chunk.brickBlockAt(x, sectionY + y, z) : EMPTY;
+            }
+        }, cellSize, sampling, &counts, &countedLayer, &cells[i * perSection]);
+    }
+    emitLodFaces(cells, chunk.minSection(), level, out);
+}
+
+
+// The faces go in the buffers Drawable keeps for interleaved position,
+// normal and colour data, and are drawn with QuadIndices, six indices
+// each
+void ChunkMesh::createCubeVBO(const MeshBuffers &mesh){
+    generatePosNorCol();
+    bool replaced = uploadFaces(&m_bufPosNorCol, &m_layout, mesh.faces, mesh.meshedSections);
+    generateTransPosNorCol();
+    bool transReplaced = uploadFaces(&m_transBufPosNorCol, &m_transLayout, mesh.transFaces,
+                                     mesh.meshedSections);
+    m_count = m_layout.faceCount * 6;
+    m_transCount = m_transLayout.faceCount * 6;
+
+    if(!m_faceTexGenerated) {
+        m_faceTexGenerated = true;
+        mp_context->glGenTextures(1, &m_faceTex);
+        mp_context->glGenTextures(1, &m_transFaceTex);
+        replaced = transReplaced = true;
+    }
+    // A buffer texture follows its buffer, so this only needs doing
+    // when the buffer itself is replaced
+    if(replaced) {
+        mp_context->glBindTexture(GL_TEXTURE_BUFFER, m_faceTex);
+        mp_context->glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, m_bufPosNorCol);
+    }
+    if(transReplaced) {
+        mp_context->glBindTexture(GL_TEXTURE_BUFFER, m_transFaceTex);
+        mp_context->glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, m_transBufPosNorCol);
+    }
+    mp_context->glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+bool ChunkMesh::uploadFaces(GLuint *buf, FaceLayout *layout, const std::vector<ChunkFace> &faces,
+                            const std::bitset<SECTION_COUNT> &sections) {
+    typedef FaceLayout::Slot Slot;
+    // The run each section's faces take up in faces
+    std::vector<Slot> incoming;
+    for(uint32_t i = 0; i < faces.size(); ++i) {
+        int s = faces[i].section();
+        if(incoming.empty() || incoming.back().section != s) {
+            incoming.push_back(Slot{s, i, 0, 0});
+        }
+        incoming.back().count++;
+        incoming.back().capacity++;
+    }
+
+    bool replaced = false;
+    mp_context->glBindBuffer(GL_ARRAY_BUFFER, *buf);
+    if(sections.all()) {
+        uint32_t count = faces.size();
+        if(count > layout->capacity || layout->capacity == 0) {
+            // Leave room to grow, so that a remesh after an edit is
+            // usually written in place
+            layout->capacity = std::max(count + count / 4, 1u);
+            mp_context->glBufferData(GL_ARRAY_BUFFER, layout->capacity * sizeof(ChunkFace),
+                                     nullptr, GL_DYNAMIC_DRAW);
+        }
+        mp_context->glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(ChunkFace), faces.data());
+        layout->slots = incoming;
+        layout->end = count;
+    } else {
+        auto slotOf = [layout](int section) {
+            return std::lower_bound(layout->slots.begin(), layout->slots.end(), section,
+                                    [](const Slot &slot, int s) { return slot.section < s; });
+        };
+        // The meshed sections lose their faces, but keep their room
+        uint32_t moving = 0;
+        for(Slot &slot : layout->slots) {
+            if(sections.test(slot.section)) {
+                slot.count = 0;
+            }
+        }
+        for(const Slot &in : incoming) {
+            auto slot = slotOf(in.section);
+            if(slot == layout->slots.end() || slot->section != in.section || in.count > slot->capacity) {
+                moving += in.count;
+            }
+        }
+        if(layout->end + moving > layout->capacity) {
+            // Packing drops the meshed sections' room, so every one of
+            // them goes at the end
+            uint32_t total = 0;
+            for(const Slot &in : incoming) {
+                total += in.count;
+            }
+            growBuffer(buf, layout, total);
+            replaced = true;
+        }
+        for(const Slot &in : incoming) {
+            auto slot = slotOf(in.section);
+            if(slot == layout->slots.end() || slot->section != in.section) {
+                slot = layout->slots.insert(slot, Slot{in.section, layout->end, 0, 0});
+            }
+            if(in.count > slot->capacity) {
+                slot->first = layout->end;
+                slot->capacity = in.count;
+                layout->end += in.count;
+            }
+            slot->count = in.count;
+            mp_context->glBufferSubData(GL_ARRAY_BUFFER, slot->first * sizeof(ChunkFace),
+                                        in.count * sizeof(ChunkFace), &faces[in.first]);
+        }
+    }
+
+    // Slots that have moved leave gaps, which are skipped by drawing
+    // each run of slots separately
+    layout->faceCount = 0;
+    for(const Slot &slot : layout->slots) {
+        layout->faceCount += slot.count;
+    }
+    collectRanges(*layout, 0, SECTION_COUNT - 1, &layout->ranges);
+    return replaced;
+}
+
+void ChunkMesh::collectRanges(const FaceLayout &layout, int minSection, int maxSection,
+                              std::vector<FaceRange> *out) {
+    out->clear();
+    for(const FaceLayout::Slot &slot : layout.slots) {
+        if(slot.count > 0 && slot.section >= minSection && slot.section <= maxSection) {
+            out->push_back(FaceRange{slot.first, slot.count});
+        }
+    }
+    std::sort(out->begin(), out->end(),
+              [](const FaceRange &a, const FaceRange &b) { return a.first < b.first; });
+    size_t runs = 0;
+    for(const FaceRange &range : *out) {
+        if(runs > 0 && (*out)[runs - 1].first + (*out)[runs - 1].count == range.first) {
+            (*out)[runs - 1].count += range.count;
+        } else {
+            (*out)[runs++] = range;
+        }
+    }
+    out->resize(runs);
+}
+
+void ChunkMesh::growBuffer(GLuint *buf, FaceLayout *layout, uint32_t extra) {
+    uint32_t live = 0;
+    for(const FaceLayout::Slot &slot : layout->slots) {
+        live += slot.count;
+    }
+    uint32_t capacity = std::max(live + extra + (live + extra) / 4, 1u);
+
+    GLuint grown;
+    mp_context->glGenBuffers(1, &grown);
+    mp_context->glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    mp_context->glBufferData(GL_COPY_WRITE_BUFFER, capacity * sizeof(ChunkFace), nullptr, GL_DYNAMIC_DRAW);
+    mp_context->glBindBuffer(GL_COPY_READ_BUFFER, *buf);
+    // The faces never leave the GPU
+    uint32_t end = 0;
+    for(auto slot = layout->slots.begin(); slot != layout->slots.end();) {
+        if(slot->count == 0) {
+            slot = layout->slots.erase(slot);
+            continue;
+        }
+        mp_context->glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                        slot->first * sizeof(ChunkFace), end * sizeof(ChunkFace),
+                                        slot->count * sizeof(ChunkFace));
+        slot->first = end;
+        slot->capacity = slot->count;
+        end += slot->count;
+        ++slot;
+    }
+
+    mp_context->glDeleteBuffers(1, buf);
+    *buf = grown;
+    mp_context->glBindBuffer(GL_ARRAY_BUFFER, grown);
+    layout->end = end;
+    layout->capacity = capacity;
+}
+
+bool ChunkMesh::bindFaces() {
+    if(m_faceTexGenerated) {
+        mp_context->glBindTexture(GL_TEXTURE_BUFFER, m_faceTex);
+    }
+    return m_faceTexGenerated;
+}
+
+bool ChunkMesh::bindTransFaces() {
+    if(m_faceTexGenerated) {
+        mp_context->glBindTexture(GL_TEXTURE_BUFFER, m_transFaceTex);
+    }
+    return m_faceTexGenerated;
+}
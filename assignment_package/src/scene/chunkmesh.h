@@ -0,0 +1,227 @@
+#pragma once
+#include "drawable.h"
+#include "chunkdata.h"
+
+#include <vector>
+
+class ChunkTree;
+
+// One face of a Chunk, packed into 8 bytes. The faces are stored in a
+// buffer texture, and lambert.vert.glsl builds each one's four corners
+// from it (see corners there).
+// The face's normal and UVs follow from its direction and atlas tile,
+// and its colour is the same everywhere, so none of them are stored.
+struct ChunkFace {
+    // Chunk-local position of the face's lowest block: bits 0-4 hold x,
+    // bits 5-9 z and bits 10-22 y - WORLD_MIN_Y
+    uint32_t position;
+    // Bits 0-2 hold the face's Direction, bit 3 whether it is animated,
+    // bits 4-11 its atlas tile (column + 16 * row) and bits 12-23 the
+    // number of blocks it covers along x, y and z, less one, in four
+    // bits each. Along the face's normal that is 1, or the cell size of
+    // a level-of-detail mesh.
+    uint32_t face;
+
+    ChunkFace() = default;
+    ChunkFace(glm::ivec3 pos, glm::ivec3 size, uint32_t face)
+        : position(pos.x | (pos.z << 5) | ((pos.y - WORLD_MIN_Y) << 10)),
+          face(face | ((size.x - 1) << 12) | ((size.y - 1) << 16) | ((size.z - 1) << 20))
+    {}
+
+    // The section the face belongs to. No face reaches past its section.
+    int section() const {
+        return (position >> 10) / SECTION_HEIGHT;
+    }
+};
+
+// A run of count faces starting at face first of a buffer
+struct FaceRange {
+    uint32_t first;
+    uint32_t count;
+};
+
+// How the mesher turns visible block faces into quads
+enum MeshMode : unsigned char
+{
+    // One quad per visible face
+    PER_FACE,
+    // Runs of coplanar faces of the same block type, within one section,
+    // merged into as few rectangles as possible. The shader repeats the
+    // face's texture once per block across each rectangle.
+    GREEDY
+};
+
+// Levels of detail below a Chunk's full mesh, for Chunks far from the
+// Player. Level l meshes the Chunk in cells of 2^l blocks on a side.
+static const int LOD_LEVELS = 3;
+// How far, in blocks, the skirts along a level of detail's sides reach
+// below the coarse surface (see ChunkMesh::createLodChunk)
+static const int LOD_SKIRT_DEPTH = 8;
+
+// How a level-of-detail mesh picks the type of each cell. Either way a
+// cell is solid if any of its blocks is, so that coarse terrain never
+// sinks below the finer terrain next to it.
+enum LodSampling : unsigned char
+{
+    // The most common type among the cell's blocks
+    MAJORITY,
+    // The most common type among the highest blocks in the cell, so
+    // that grass-topped ground stays green from afar
+    TOP_SURFACE
+};
+
+// Where the mesher writes a Chunk's mesh, and what VBOWorkers hand to
+// the game thread for upload: one ChunkFace per quad, with no vertices
+// or indices, in order of section. clear() keeps the vectors' capacity,
+// so a recycled MeshBuffers (see MeshBufferPool) meshes its next Chunk
+// without reallocating.
+struct MeshBuffers {
+    std::vector<ChunkFace> faces;
+    std::vector<ChunkFace> transFaces;
+    // The sections whose faces these are: every one for a whole Chunk,
+    // or those an edit touched, whose faces replace just their own in
+    // the Chunk's ChunkMesh. Sections meshed without any faces count.
+    std::bitset<SECTION_COUNT> meshedSections = std::bitset<SECTION_COUNT>().set();
+    // GREEDY mode's per-section face cells (see faceCell in
+    // chunkmesh.cpp). Scratch space, not part of the mesh.
+    std::vector<BlockType> faceCells;
+
+    void clear();
+    // Bytes held by the vectors, whether in use or not
+    size_t capacityBytes() const;
+
+    // Appends a face covering size blocks (1 along the face's normal, in
+    // full meshes) starting at the block at pos
+    void addFace(Direction dir, BlockType type, glm::ivec3 pos, glm::ivec3 size);
+};
+
+// The index buffer every ChunkMesh is drawn with. Face f's corners are
+// the vertices 4f to 4f + 3, whose IDs lambert.vert.glsl turns back into
+// the face and corner, so the indices only ever repeat 0, 1, 2, 0, 2, 3
+// four vertices further on. One buffer of that pattern, drawn from a
+// base vertex, serves every Chunk.
+class QuadIndices : public Drawable {
+public:
+    // Quads the buffer covers, as many as 16-bit indices reach. Longer
+    // meshes are drawn in several batches.
+    static const int QUAD_COUNT = 16384;
+
+    QuadIndices(OpenGLContext *context);
+    void create() override;
+};
+
+// The GPU side of one Chunk: the VBOs of its opaque faces and of its
+// transparent ones. Terrain only keeps ChunkMeshes for the Chunks near
+// the Player.
+class ChunkMesh : public Drawable {
+private:
+    // The Chunk that create() meshes
+    ChunkData *mp_chunk;
+    // The number of indices the transparent quads are drawn with
+    int m_transCount;
+    MeshMode m_mode;
+
+    // Where each section's faces lie in one of the face buffers. A whole
+    // mesh is packed tightly; a section meshed on its own afterwards is
+    // written over its old faces if it fits there, and otherwise goes
+    // after the last slot, the buffer being reallocated (and packed)
+    // when it runs out of room.
+    struct FaceLayout {
+        struct Slot {
+            int section;
+            uint32_t first;
+            uint32_t count;
+            // Faces the slot can hold before the section has to move
+            uint32_t capacity;
+        };
+        std::vector<Slot> slots; // Ordered by section
+        uint32_t end;            // One past the end of the last slot
+        uint32_t capacity;       // Faces the buffer has room for
+        uint32_t faceCount;      // Faces in all the slots
+        // The slots' faces as runs to draw, neighbouring slots merged
+        std::vector<FaceRange> ranges;
+    };
+    FaceLayout m_layout;
+    FaceLayout m_transLayout;
+
+    // Buffer textures over the face buffers (m_bufPosNorCol and
+    // m_transBufPosNorCol), which is how the shader reads them
+    GLuint m_faceTex;
+    GLuint m_transFaceTex;
+    bool m_faceTexGenerated;
+
+    // Uploads the faces of the given sections into *buf, as laid out
+    // by layout. Returns true if *buf had to be replaced by a larger
+    // buffer.
+    bool uploadFaces(GLuint *buf, FaceLayout *layout, const std::vector<ChunkFace> &faces,
+                     const std::bitset<SECTION_COUNT> &sections);
+    // The faces of the layout's slots from minSection to maxSection as
+    // runs to draw, neighbouring slots merged
+    static void collectRanges(const FaceLayout &layout, int minSection, int maxSection,
+                              std::vector<FaceRange> *out);
+    // Moves every slot's faces into a new buffer with room for at least
+    // extra more faces, packed in order of section
+    void growBuffer(GLuint *buf, FaceLayout *layout, uint32_t extra);
+
+public:
+    ChunkMesh(OpenGLContext *context, ChunkData *chunk, MeshMode mode = GREEDY);
+
+    // Meshes the Chunk's current blocks on the calling thread
+    // and uploads them
+    void create() override;
+    // Also frees the buffer textures
+    void destroy() override;
+    int transElemCount();
+    // The runs of faces to draw from each face buffer
+    const std::vector<FaceRange> &faceRanges() const;
+    const std::vector<FaceRange> &transFaceRanges() const;
+    // The same for sections minSection to maxSection only, written into out
+    void faceRanges(int minSection, int maxSection, std::vector<FaceRange> *out) const;
+    void transFaceRanges(int minSection, int maxSection, std::vector<FaceRange> *out) const;
+
+    // Bind the buffer texture of the opaque, or the transparent, faces
+    // to the active texture unit
+    bool bindFaces();
+    bool bindTransFaces();
+    // Applies from the next call to create()
+    void setMode(MeshMode mode);
+
+    // Builds a Chunk's mesh from the given snapshots into out, replacing
+    // whatever it held: the whole Chunk, or only the given sections.
+    // Touches no Chunk and no GL state, so it can run on a worker thread.
+    static void createChunk(const MeshInput &input, MeshBuffers *out,
+                            MeshMode mode = GREEDY,
+                            const std::bitset<SECTION_COUNT> *sections = nullptr);
+    // Builds the given level of detail (1 to LOD_LEVELS) of a Chunk into
+    // out. Reads no neighbours: faces on the Chunk's sides are kept from
+    // the top of each column of cells to LOD_SKIRT_DEPTH blocks below
+    // it, and act as skirts over the seams between Chunks meshed at
+    // different levels.
+    static void createLodChunk(const ChunkSnapshot &chunk, int level,
+                               LodSampling sampling, MeshBuffers *out);
+    // The same from a frozen Chunk's tree, which leaves the Chunk
+    // compressed. The tree only keeps one type per 4 x 4 x 4 brick, so
+    // cells finer than that take their brick's type.
+    static void createLodChunk(const ChunkTree &chunk, int level,
+                               LodSampling sampling, MeshBuffers *out);
+
+    /*
+     * Want to know for each block, what is around it, and that determines what
+     * you render.
+     *
+     * Loop through X, Y, Z and search through block
+     *
+     * A mesh of only some sections updates just those sections of the
+     * mesh uploaded before it.
+     */
+    void createCubeVBO(const MeshBuffers &mesh);
+};
+
+// The step to the neighbouring block in each Direction, in the order
+// they are declared in. The corners of each Direction's faces are only
+// known to lambert.vert.glsl.
+const static std::array<glm::ivec3, 6> directionVecs{
+    glm::ivec3(1, 0, 0), glm::ivec3(-1, 0, 0),
+    glm::ivec3(0, 1, 0), glm::ivec3(0, -1, 0),
+    glm::ivec3(0, 0, 1), glm::ivec3(0, 0, -1)
+};
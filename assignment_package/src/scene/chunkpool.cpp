@@ -0,0 +1,156 @@
+#include "chunkpool.h"
+#include "chunkdata.h"
+#include <algorithm>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// Slabs are a multiple of the usual 2 MiB huge page size
+#define SLAB_BYTES (4 * 1024 * 1024)
+
+SlabPool::SlabPool(size_t blockSize, size_t slabBytes) :
+    m_blockSize((blockSize + 63) & ~static_cast<size_t>(63)),
+    m_slabBytes(slabBytes), m_slabs(), m_free(), m_inUse(0)
+{}
+
+SlabPool::~SlabPool() {
+    for(Slab &s : m_slabs) {
+#ifdef __linux__
+        munmap(s.memory, s.bytes);
+#else
+        ::operator delete(s.memory);
+#endif
+    }
+}
+
+void SlabPool::addSlab() {
+    Slab s{nullptr, m_slabBytes, false};
+#ifdef __linux__
+    s.memory = mmap(nullptr, s.bytes, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(s.memory == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    // Ask for transparent huge pages; this fails harmlessly if the
+    // kernel does not support them
+    s.hugePages = madvise(s.memory, s.bytes, MADV_HUGEPAGE) == 0;
+#else
+    s.memory = ::operator new(s.bytes);
+#endif
+    m_slabs.push_back(s);
+
+    // Push blocks in reverse so they are handed out in address order
+    char *base = static_cast<char*>(s.memory);
+    size_t count = s.bytes / m_blockSize;
+    for(size_t i = count; i > 0; --i) {
+        m_free.push_back(base + (i - 1) * m_blockSize);
+    }
+}
+
+void *SlabPool::acquire() {
+    if(m_free.empty()) {
+        addSlab();
+    }
+    void *p = m_free.back();
+    m_free.pop_back();
+    ++m_inUse;
+    return p;
+}
+
+void SlabPool::release(void *p) {
+    m_free.push_back(p);
+    --m_inUse;
+}
+
+size_t SlabPool::blockSize() const {
+    return m_blockSize;
+}
+
+size_t SlabPool::slabCount() const {
+    return m_slabs.size();
+}
+
+size_t SlabPool::hugePageSlabCount() const {
+    size_t n = 0;
+    for(const Slab &s : m_slabs) {
+        n += s.hugePages;
+    }
+    return n;
+}
+
+size_t SlabPool::capacity() const {
+    return m_slabs.size() * (m_slabBytes / m_blockSize);
+}
+
+size_t SlabPool::inUse() const {
+    return m_inUse;
+}
+
+ChunkPool::ChunkPool() : m_pools(), m_mutex() {
+    m_pools.emplace_back(sizeof(ChunkData), SLAB_BYTES);
+    // Packed section indices at 1, 2, 4 and 8 bits per block
+    for(size_t bits = 1; bits <= 8; bits *= 2) {
+        m_pools.emplace_back(SECTION_VOLUME * bits / 8, SLAB_BYTES);
+    }
+    std::sort(m_pools.begin(), m_pools.end(),
+              [](const SlabPool &a, const SlabPool &b) {
+                  return a.blockSize() < b.blockSize();
+              });
+}
+
+ChunkPool &ChunkPool::instance() {
+    static ChunkPool pool;
+    return pool;
+}
+
+SlabPool *ChunkPool::poolFor(size_t bytes) {
+    // Smallest size class that the request fills at least half of
+    for(SlabPool &p : m_pools) {
+        if(bytes <= p.blockSize()) {
+            return bytes > p.blockSize() / 2 ? &p : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+void *ChunkPool::allocate(size_t bytes) {
+    void *mem = nullptr;
+    {
+        // acquire() throws std::bad_alloc when no new slab can be mapped,
+        // which must not leave the pool locked
+        QMutexLocker locker(&m_mutex);
+        SlabPool *p = poolFor(bytes);
+        if(p != nullptr) {
+            mem = p->acquire();
+        }
+    }
+    return mem != nullptr ? mem : ::operator new(bytes);
+}
+
+void ChunkPool::deallocate(void *p, size_t bytes) {
+    SlabPool *pool;
+    {
+        QMutexLocker locker(&m_mutex);
+        pool = poolFor(bytes);
+        if(pool != nullptr) {
+            pool->release(p);
+        }
+    }
+    if(pool == nullptr) {
+        ::operator delete(p);
+    }
+}
+
+std::vector<ChunkPool::Stats> ChunkPool::stats() {
+    std::vector<Stats> result;
+    QMutexLocker locker(&m_mutex);
+    for(const SlabPool &p : m_pools) {
+        size_t capacity = p.capacity();
+        result.push_back(Stats{p.blockSize(), p.slabCount(), p.hugePageSlabCount(),
+                               capacity, p.inUse(),
+                               capacity == 0 ? 0.f : p.inUse() / static_cast<float>(capacity)});
+    }
+    return result;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <QMutex>
+#include <cstddef>
+#include <vector>
+
+// Hands out fixed-size blocks of memory carved from large slabs, and
+// recycles freed blocks through a free list instead of returning them
+// to the heap. Each ChunkPool size class is one SlabPool.
+class SlabPool {
+private:
+    struct Slab {
+        void *memory;
+        size_t bytes;
+        bool hugePages;
+    };
+
+    size_t m_blockSize;
+    size_t m_slabBytes;
+    std::vector<Slab> m_slabs;
+    std::vector<void*> m_free;
+    size_t m_inUse;
+
+    void addSlab();
+
+public:
+    SlabPool(size_t blockSize, size_t slabBytes);
+    SlabPool(SlabPool &&other) = default;
+    SlabPool &operator=(SlabPool &&other) = default;
+    ~SlabPool();
+
+    void *acquire();
+    void release(void *p);
+
+    size_t blockSize() const;
+    size_t slabCount() const;
+    size_t hugePageSlabCount() const;
+    size_t capacity() const;
+    size_t inUse() const;
+};
+
+// The allocator behind every Chunk object and every section's packed
+// block indices. Terrain and the worker threads allocate Chunks as usual
+// (mkU<ChunkData>, which uses ChunkData::operator new) and PaletteStorage
+// allocates through PoolAllocator, so all of that memory comes from
+// slabs reserved up front, backed by huge pages where the OS offers them.
+// Allocations that match none of the size classes fall back to the heap.
+class ChunkPool {
+private:
+    // One pool for Chunk objects, one per packed index width,
+    // sorted by block size
+    std::vector<SlabPool> m_pools;
+    QMutex m_mutex;
+
+    ChunkPool();
+    SlabPool *poolFor(size_t bytes);
+
+public:
+    struct Stats {
+        size_t blockSize;
+        size_t slabs;
+        size_t hugePageSlabs;
+        size_t capacity;  // Blocks available across all slabs
+        size_t inUse;     // Blocks currently handed out
+        float occupancy;  // inUse / capacity
+    };
+
+    static ChunkPool &instance();
+
+    void *allocate(size_t bytes);
+    void deallocate(void *p, size_t bytes);
+
+    // Slab occupancy of every size class
+    std::vector<Stats> stats();
+};
+
+// Lets standard containers allocate from the ChunkPool
+template<typename T>
+struct PoolAllocator {
+    typedef T value_type;
+
+    PoolAllocator() {}
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+
+    T *allocate(size_t n) {
+        return static_cast<T*>(ChunkPool::instance().allocate(n * sizeof(T)));
+    }
+    void deallocate(T *p, size_t n) {
+        ChunkPool::instance().deallocate(p, n * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U>&) const { return true; }
+    template<typename U>
+    bool operator!=(const PoolAllocator<U>&) const { return false; }
+};
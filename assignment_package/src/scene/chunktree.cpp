@@ -0,0 +1,168 @@
+#include "chunktree.h"
+#include <QtAlgorithms>
+#include <array>
+
+ChunkTree::ChunkTree(const ChunkSnapshot &snapshot) :
+    m_minSection(snapshot.minSection), m_nodes(), m_brickTypes(), m_leaves()
+{
+    m_nodes.reserve(snapshot.sections.size());
+    for(const std::shared_ptr<const ChunkSection> &sectionPtr : snapshot.sections) {
+        const ChunkSection &section = *sectionPtr;
+        Node node{0, 0, 0, 0, section.get(0, 0, 0), true};
+        if(section.isUniform()) {
+            node.occupied = node.type == EMPTY ? 0 : ~0ull;
+            m_nodes.push_back(node);
+            continue;
+        }
+
+        node.uniform = false;
+        node.firstBrick = m_brickTypes.size();
+        node.firstLeaf = m_leaves.size();
+        for(int b = 0; b < 64; ++b) {
+            int bx = b & 3, bz = (b >> 2) & 3, by = b >> 4;
+            Leaf brick{0, 0};
+            std::array<int, 256> counts{};
+            for(int y = 0; y < 4; ++y) {
+                for(int z = 0; z < 4; ++z) {
+                    for(int x = 0; x < 4; ++x) {
+                        BlockType t = section.get(4 * bx + x, 4 * by + y, 4 * bz + z);
+                        uint64_t bit = 1ull << childIndex(x, y, z);
+                        counts[t]++;
+                        if(t != EMPTY) {
+                            brick.occupied |= bit;
+                            if(!isTransparent(t)) {
+                                brick.opaque |= bit;
+                            }
+                        }
+                    }
+                }
+            }
+
+            BlockType common = EMPTY;
+            counts[EMPTY] = 0;
+            for(int t = 1; t < 256; ++t) {
+                if(counts[t] > counts[common]) {
+                    common = static_cast<BlockType>(t);
+                }
+            }
+            m_brickTypes.push_back(common);
+            if(brick.occupied != 0) {
+                node.occupied |= 1ull << b;
+            }
+            // The brick's type alone describes it if it is all empty,
+            // all opaque or all transparent
+            bool described = brick.occupied == 0 ||
+                              (brick.occupied == ~0ull &&
+                               brick.opaque == (isTransparent(common) ? 0 : ~0ull));
+            if(!described) {
+                m_leaves.push_back(brick);
+                node.mixed |= 1ull << b;
+            }
+        }
+
+        // A section whose bricks all came out the same collapses too
+        bool same = node.mixed == 0;
+        for(int b = 1; same && b < 64; ++b) {
+            same = m_brickTypes[node.firstBrick + b] == m_brickTypes[node.firstBrick];
+        }
+        if(same) {
+            node.type = m_brickTypes[node.firstBrick];
+            node.uniform = true;
+            m_brickTypes.resize(node.firstBrick);
+        }
+        m_nodes.push_back(node);
+    }
+    m_brickTypes.shrink_to_fit();
+    m_leaves.shrink_to_fit();
+}
+
+const ChunkTree::Node *ChunkTree::node(int s) const {
+    int i = s - m_minSection;
+    if(i < 0 || i >= static_cast<int>(m_nodes.size())) {
+        return nullptr;
+    }
+    return &m_nodes[i];
+}
+
+const ChunkTree::Leaf &ChunkTree::leaf(const Node &node, int brick) const {
+    // Leaves are stored in brick order, so the leaf of a brick comes
+    // after one leaf per lower mixed brick
+    uint64_t lower = node.mixed & ((1ull << brick) - 1);
+    return m_leaves[node.firstLeaf + qPopulationCount(static_cast<quint64>(lower))];
+}
+
+bool ChunkTree::isOccupiedAt(int x, int y, int z) const {
+    if(!isBrickOccupied(x, y, z)) {
+        return false;
+    }
+    const Node &n = *node(sectionOf(y));
+    int ly = y - sectionFloor(sectionOf(y));
+    int b = childIndex(x >> 2, ly >> 2, z >> 2);
+    if(((n.mixed >> b) & 1) == 0) {
+        return true;
+    }
+    return (leaf(n, b).occupied >> childIndex(x & 3, ly & 3, z & 3)) & 1;
+}
+
+bool ChunkTree::isOpaqueAt(int x, int y, int z) const {
+    if(!isBrickOccupied(x, y, z)) {
+        return false;
+    }
+    const Node &n = *node(sectionOf(y));
+    int ly = y - sectionFloor(sectionOf(y));
+    int b = childIndex(x >> 2, ly >> 2, z >> 2);
+    if(((n.mixed >> b) & 1) == 0) {
+        return !isTransparent(brickBlockAt(x, y, z));
+    }
+    return (leaf(n, b).opaque >> childIndex(x & 3, ly & 3, z & 3)) & 1;
+}
+
+BlockType ChunkTree::brickBlockAt(int x, int y, int z) const {
+    if(x < 0 || x >= X_BOUND || y < WORLD_MIN_Y || y >= WORLD_MAX_Y || z < 0 || z >= Z_BOUND) {
+        return EMPTY;
+    }
+    const Node *n = node(sectionOf(y));
+    if(n == nullptr) {
+        return EMPTY;
+    }
+    if(n->uniform) {
+        return n->type;
+    }
+    int ly = y - sectionFloor(sectionOf(y));
+    return m_brickTypes[n->firstBrick + childIndex(x >> 2, ly >> 2, z >> 2)];
+}
+
+bool ChunkTree::isBrickOccupied(int x, int y, int z) const {
+    if(x < 0 || x >= X_BOUND || y < WORLD_MIN_Y || y >= WORLD_MAX_Y || z < 0 || z >= Z_BOUND) {
+        return false;
+    }
+    const Node *n = node(sectionOf(y));
+    if(n == nullptr) {
+        return false;
+    }
+    int ly = y - sectionFloor(sectionOf(y));
+    return (n->occupied >> childIndex(x >> 2, ly >> 2, z >> 2)) & 1;
+}
+
+bool ChunkTree::isSectionOccupied(int y) const {
+    if(y < WORLD_MIN_Y || y >= WORLD_MAX_Y) {
+        return false;
+    }
+    const Node *n = node(sectionOf(y));
+    return n != nullptr && n->occupied != 0;
+}
+
+int ChunkTree::minSection() const {
+    return m_minSection;
+}
+
+int ChunkTree::sectionCount() const {
+    return m_nodes.size();
+}
+
+size_t ChunkTree::memoryUsage() const {
+    return sizeof(ChunkTree) +
+           m_nodes.capacity() * sizeof(Node) +
+           m_brickTypes.capacity() * sizeof(BlockType) +
+           m_leaves.capacity() * sizeof(Leaf);
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "chunkdata.h"
+
+#include <vector>
+#include <cstdint>
+
+// A read-only 64-tree over the blocks of one Chunk, for Chunks far from
+// the Player. Every stored section is a node split 4 x 4 x 4 into 64
+// bricks of 4 x 4 x 4 blocks each.
+// The tree keeps which blocks are occupied and which are opaque exactly,
+// but only one representative block type per brick, which is all that
+// distant views and long rays need (the Chunk's exact blocks stay in
+// the cold tier). Sections and bricks that are entirely empty, or
+// entirely opaque, or entirely transparent keep no masks at all, so the
+// tree's size grows with how much surface the Chunk has rather than
+// with its volume. The masks on each level let ray queries skip empty
+// space 16 or 4 blocks at a time.
+class ChunkTree {
+public:
+    // A brick that is only partly occupied, or only partly opaque
+    struct Leaf {
+        uint64_t occupied; // Bit per block that is not EMPTY
+        uint64_t opaque;   // Bit per block that is opaque
+    };
+
+    // One 16 x 16 x 16 section
+    struct Node {
+        uint64_t occupied;   // Bricks holding any block that is not EMPTY
+        uint64_t mixed;      // Bricks that have a Leaf
+        uint32_t firstBrick; // Offset of the section's 64 brick types
+        uint32_t firstLeaf;  // Offset of the Leaf of its lowest mixed brick
+        BlockType type;      // The whole section's type if it is uniform
+        bool uniform;
+    };
+
+    // Index of child x, y, z (each 0 to 3) within a brick or section
+    static int childIndex(int x, int y, int z) {
+        return x + 4 * (z + 4 * y);
+    }
+
+private:
+    int m_minSection;
+    std::vector<Node> m_nodes;
+    // For each brick of a non-uniform section, the most common type
+    // among its blocks that are not EMPTY, or EMPTY if it has none
+    std::vector<BlockType> m_brickTypes;
+    std::vector<Leaf> m_leaves;
+
+    // The node of section s, or null if the section is air
+    const Node *node(int s) const;
+    const Leaf &leaf(const Node &node, int brick) const;
+
+public:
+    explicit ChunkTree(const ChunkSnapshot &snapshot);
+
+    // All coordinates are Chunk-local, with y a world height; anything
+    // outside the Chunk is empty
+    bool isOccupiedAt(int x, int y, int z) const;
+    bool isOpaqueAt(int x, int y, int z) const;
+    // The representative type of the brick holding x, y, z, or EMPTY if
+    // the whole brick is empty
+    BlockType brickBlockAt(int x, int y, int z) const;
+    // Does the brick, or the section, holding x, y, z contain anything?
+    bool isBrickOccupied(int x, int y, int z) const;
+    bool isSectionOccupied(int y) const;
+    // The stored sections, the lowest of which is minSection()
+    int minSection() const;
+    int sectionCount() const;
+
+    size_t memoryUsage() const;
+};
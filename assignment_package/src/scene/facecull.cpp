@@ -0,0 +1,195 @@
+#include "facecull.h"
+#include <QtAlgorithms>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// The bit of each column that holds its top, or its bottom, block
+static const uint64_t COLUMN_TOPS = 0x8000800080008000ull;
+static const uint64_t COLUMN_BOTTOMS = 0x0001000100010001ull;
+
+// Word w of the given kind of mask of a section
+static uint64_t maskWord(const ChunkSection &section, int w, MaskKind kind, BlockType type) {
+    switch(kind) {
+    case MaskKind::OPAQUE:
+        return section.opaqueWord(w);
+    case MaskKind::TRANSPARENT:
+        return section.transparentWord(w);
+    case MaskKind::OCCUPIED:
+        return section.opaqueWord(w) | section.transparentWord(w);
+    default:
+        break;
+    }
+
+    // Picking out one transparent type means looking at the blocks
+    uint64_t transparent = section.transparentWord(w);
+    uint64_t result = 0;
+    while(transparent != 0) {
+        int i = qCountTrailingZeroBits(transparent);
+        transparent &= transparent - 1;
+        int bit = w * 64 + i;
+        if(section.get(bit >> 8, bit & 15, (bit >> 4) & 15) == type) {
+            result |= 1ull << i;
+        }
+    }
+    if(kind == MaskKind::OPAQUE_OR_TYPE) {
+        result |= section.opaqueWord(w);
+    }
+    return result;
+}
+
+void buildMask(const ChunkSnapshot &chunk, int s, MaskKind kind, BlockType type,
+               SectionMask *mask) {
+    const ChunkSection &section = chunk.section(s);
+    for(int x = 0; x < X_BOUND; ++x) {
+        for(int g = 0; g < 4; ++g) {
+            mask->rows[x][g] = maskWord(section, 4 * x + g, kind, type);
+        }
+    }
+}
+
+void buildBorderedMask(const MeshInput &input, int s, MaskKind kind, BlockType type,
+                       BorderedMask *mask) {
+    const ChunkSection &center = input.center->section(s);
+    const ChunkSection &below = input.center->section(s - 1);
+    const ChunkSection &above = input.center->section(s + 1);
+    for(int x = 0; x < X_BOUND; ++x) {
+        for(int g = 0; g < 4; ++g) {
+            int w = 4 * x + g;
+            mask->rows[x + 1][g] = maskWord(center, w, kind, type);
+            mask->below[x][g] = s > 0 ? maskWord(below, w, kind, type) & COLUMN_TOPS : 0;
+            mask->above[x][g] = s + 1 < SECTION_COUNT ? maskWord(above, w, kind, type) & COLUMN_BOTTOMS : 0;
+        }
+    }
+
+    const ChunkSnapshot *xneg = input.neighbors[XNEG].get(), *xpos = input.neighbors[XPOS].get();
+    const ChunkSnapshot *zneg = input.neighbors[ZNEG].get(), *zpos = input.neighbors[ZPOS].get();
+    for(int g = 0; g < 4; ++g) {
+        mask->rows[0][g] = xneg ? maskWord(xneg->section(s), 4 * (X_BOUND - 1) + g, kind, type) : 0;
+        mask->rows[X_BOUND + 1][g] = xpos ? maskWord(xpos->section(s), g, kind, type) : 0;
+    }
+    for(int x = 0; x < X_BOUND; ++x) {
+        // Column z = 15 is the top 16 bits of a row's last word, and
+        // column z = 0 the bottom 16 bits of its first
+        mask->zneg[x] = zneg ? maskWord(zneg->section(s), 4 * x + 3, kind, type) & 0xffff000000000000ull : 0;
+        mask->zpos[x] = zpos ? maskWord(zpos->section(s), 4 * x, kind, type) & 0xffffull : 0;
+    }
+}
+
+namespace {
+
+// The four words of one row, operated on together. Uses a single AVX2
+// register, or two SSE2 registers, when the compiler targets them.
+#if defined(__AVX2__)
+struct Row {
+    __m256i v;
+
+    static Row load(const uint64_t *p) {
+        return {_mm256_load_si256(reinterpret_cast<const __m256i*>(p))};
+    }
+    void store(uint64_t *p) const {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    static Row splat(uint64_t w) {
+        return {_mm256_set1_epi64x(static_cast<long long>(w))};
+    }
+    Row operator|(Row o) const { return {_mm256_or_si256(v, o.v)}; }
+    Row operator&(Row o) const { return {_mm256_and_si256(v, o.v)}; }
+    // This row's bits that are not set in o
+    Row andNot(Row o) const { return {_mm256_andnot_si256(o.v, v)}; }
+    template<int N> Row shr() const { return {_mm256_srli_epi64(v, N)}; }
+    template<int N> Row shl() const { return {_mm256_slli_epi64(v, N)}; }
+    // Words 1, 2, 3 and then w
+    Row next(uint64_t w) const {
+        __m256i rotated = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 2, 1));
+        return {_mm256_blend_epi32(rotated, _mm256_set1_epi64x(static_cast<long long>(w)), 0xc0)};
+    }
+    // w and then words 0, 1 and 2
+    Row prev(uint64_t w) const {
+        __m256i rotated = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 1, 0, 0));
+        return {_mm256_blend_epi32(rotated, _mm256_set1_epi64x(static_cast<long long>(w)), 0x03)};
+    }
+};
+#elif defined(__SSE2__)
+struct Row {
+    __m128i lo, hi;
+
+    static Row load(const uint64_t *p) {
+        return {_mm_load_si128(reinterpret_cast<const __m128i*>(p)),
+                _mm_load_si128(reinterpret_cast<const __m128i*>(p + 2))};
+    }
+    void store(uint64_t *p) const {
+        _mm_store_si128(reinterpret_cast<__m128i*>(p), lo);
+        _mm_store_si128(reinterpret_cast<__m128i*>(p + 2), hi);
+    }
+    static Row splat(uint64_t w) {
+        __m128i s = _mm_set1_epi64x(static_cast<long long>(w));
+        return {s, s};
+    }
+    Row operator|(Row o) const { return {_mm_or_si128(lo, o.lo), _mm_or_si128(hi, o.hi)}; }
+    Row operator&(Row o) const { return {_mm_and_si128(lo, o.lo), _mm_and_si128(hi, o.hi)}; }
+    Row andNot(Row o) const { return {_mm_andnot_si128(o.lo, lo), _mm_andnot_si128(o.hi, hi)}; }
+    template<int N> Row shr() const { return {_mm_srli_epi64(lo, N), _mm_srli_epi64(hi, N)}; }
+    template<int N> Row shl() const { return {_mm_slli_epi64(lo, N), _mm_slli_epi64(hi, N)}; }
+    Row next(uint64_t w) const {
+        __m128d l = _mm_castsi128_pd(lo), h = _mm_castsi128_pd(hi);
+        __m128d s = _mm_castsi128_pd(_mm_set1_epi64x(static_cast<long long>(w)));
+        return {_mm_castpd_si128(_mm_shuffle_pd(l, h, 1)),
+                _mm_castpd_si128(_mm_shuffle_pd(h, s, 1))};
+    }
+    Row prev(uint64_t w) const {
+        __m128d l = _mm_castsi128_pd(lo), h = _mm_castsi128_pd(hi);
+        __m128d s = _mm_castsi128_pd(_mm_set1_epi64x(static_cast<long long>(w)));
+        return {_mm_castpd_si128(_mm_shuffle_pd(s, l, 0)),
+                _mm_castpd_si128(_mm_shuffle_pd(l, h, 1))};
+    }
+};
+#else
+struct Row {
+    uint64_t w[4];
+
+    static Row load(const uint64_t *p) { return {{p[0], p[1], p[2], p[3]}}; }
+    void store(uint64_t *p) const { std::copy(w, w + 4, p); }
+    static Row splat(uint64_t v) { return {{v, v, v, v}}; }
+    Row operator|(Row o) const { return {{w[0] | o.w[0], w[1] | o.w[1], w[2] | o.w[2], w[3] | o.w[3]}}; }
+    Row operator&(Row o) const { return {{w[0] & o.w[0], w[1] & o.w[1], w[2] & o.w[2], w[3] & o.w[3]}}; }
+    Row andNot(Row o) const { return {{w[0] & ~o.w[0], w[1] & ~o.w[1], w[2] & ~o.w[2], w[3] & ~o.w[3]}}; }
+    template<int N> Row shr() const { return {{w[0] >> N, w[1] >> N, w[2] >> N, w[3] >> N}}; }
+    template<int N> Row shl() const { return {{w[0] << N, w[1] << N, w[2] << N, w[3] << N}}; }
+    Row next(uint64_t v) const { return {{w[1], w[2], w[3], v}}; }
+    Row prev(uint64_t v) const { return {{v, w[0], w[1], w[2]}}; }
+};
+#endif
+
+}
+
+void cullFaces(const SectionMask &material, const BorderedMask &blockers,
+               std::array<SectionMask, 6> *faces) {
+    const Row notTops = Row::splat(~COLUMN_TOPS);
+    const Row notBottoms = Row::splat(~COLUMN_BOTTOMS);
+    for(int x = 0; x < X_BOUND; ++x) {
+        Row m = Row::load(material.rows[x]);
+        Row b = Row::load(blockers.rows[x + 1]);
+
+        m.andNot(Row::load(blockers.rows[x + 2])).store((*faces)[XPOS].rows[x]);
+        m.andNot(Row::load(blockers.rows[x])).store((*faces)[XNEG].rows[x]);
+
+        // Within a column the block above is one bit up, except that the
+        // top block's is the bottom block of the section above
+        Row up = (b.shr<1>() & notTops) | Row::load(blockers.above[x]).shl<15>();
+        Row down = (b.shl<1>() & notBottoms) | Row::load(blockers.below[x]).shr<15>();
+        m.andNot(up).store((*faces)[YPOS].rows[x]);
+        m.andNot(down).store((*faces)[YNEG].rows[x]);
+
+        // The next column along z is 16 bits up the same word, or at the
+        // bottom of the next word
+        Row zUp = b.shr<16>() | b.next(blockers.zpos[x]).shl<48>();
+        Row zDown = b.shl<16>() | b.prev(blockers.zneg[x]).shr<48>();
+        m.andNot(zUp).store((*faces)[ZPOS].rows[x]);
+        m.andNot(zDown).store((*faces)[ZNEG].rows[x]);
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "chunkdata.h"
+
+#include <array>
+#include <cstdint>
+
+// Binary face culling: decides which faces of a whole section are
+// visible with a few bitwise operations per row rather than a branch per
+// block. Masks use the layout of ChunkSection's (see
+// ChunkSection::maskBit): row x is four words, each holding four 16-block
+// columns, so one 256-bit row covers a whole x slice of a section and
+// the faces of every block in it are found at once.
+
+// One bit per block of a section, by row
+struct SectionMask {
+    alignas(32) uint64_t rows[X_BOUND][4];
+};
+
+// The blocks that hide faces, for a section plus the one-block border
+// around it that its outermost faces look into. Everything is kept in
+// the bit position of the center block it borders.
+struct BorderedMask {
+    // Rows x = -1 to 16, so that row x of the section is rows[x + 1]
+    alignas(32) uint64_t rows[X_BOUND + 2][4];
+    // Bit 15 of each column: the top block of the section underneath
+    alignas(32) uint64_t below[X_BOUND][4];
+    // Bit 0 of each column: the bottom block of the section above
+    alignas(32) uint64_t above[X_BOUND][4];
+    // For each x, column z = -1 in bits 48 to 63 and column z = 16 in
+    // bits 0 to 15
+    uint64_t zneg[X_BOUND];
+    uint64_t zpos[X_BOUND];
+};
+
+// Which blocks a mask selects
+enum class MaskKind : unsigned char {
+    OPAQUE,
+    TRANSPARENT,
+    OCCUPIED,
+    // Transparent blocks of one type, alone or together with every
+    // opaque block
+    TYPE,
+    OPAQUE_OR_TYPE
+};
+
+// Fills mask with the blocks of section s of the given Chunk
+void buildMask(const ChunkSnapshot &chunk, int s, MaskKind kind, BlockType type,
+               SectionMask *mask);
+// Fills mask with the blocks of section s of input.center, plus its
+// border from the sections above and below and from the four
+// neighbouring Chunks. Missing neighbours are air.
+void buildBorderedMask(const MeshInput &input, int s, MaskKind kind, BlockType type,
+                       BorderedMask *mask);
+
+// Sets faces[d] to the blocks of material whose neighbour in direction d
+// is not one of blockers
+void cullFaces(const SectionMask &material, const BorderedMask &blockers,
+               std::array<SectionMask, 6> *faces);
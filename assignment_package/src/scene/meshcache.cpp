@@ -0,0 +1,344 @@
+#include "meshcache.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Bump whenever ChunkFace's layout or the mesher's output changes, so
+// that meshes cached by older builds are never used
+static const uint32_t MESH_FORMAT_VERSION = 1;
+// "MMSH", at the start of every cache file
+static const uint32_t MESH_FILE_MAGIC = 0x48534d4d;
+// More faces than any Chunk can have; larger counts mean a damaged file
+static const uint32_t MAX_FILE_FACES = 6 * X_BOUND * Z_BOUND * (WORLD_MAX_Y - WORLD_MIN_Y);
+
+namespace {
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t faceCount;
+    uint32_t transFaceCount;
+};
+
+// A 64-bit hash fed one word at a time
+class Hasher {
+private:
+    uint64_t m_h;
+
+public:
+    explicit Hasher(uint64_t seed) : m_h(seed ^ 0x9e3779b97f4a7c15ull) {}
+
+    void add(uint64_t w) {
+        m_h = (m_h ^ w) * 0xff51afd7ed558ccdull;
+        m_h ^= m_h >> 32;
+    }
+    void add(const BlockType *blocks, size_t count) {
+        for(size_t i = 0; i < count; i += 8) {
+            uint64_t w = 0;
+            std::memcpy(&w, blocks + i, std::min<size_t>(8, count - i));
+            add(w);
+        }
+    }
+    uint64_t value() const {
+        uint64_t h = m_h * 0xc4ceb9fe1a85ec53ull;
+        return h ^ (h >> 29);
+    }
+};
+
+// Tags that keep the different parts of a key apart
+enum : uint64_t { SECTION_TAG = 1, UNIFORM_TAG, BORDER_TAG, MISSING_TAG, LOD_TAG };
+
+// Adds the 16 x 16 slice of section s of chunk at x = sliceX, or at
+// z = sliceZ (whichever is not -1). A missing Chunk is all air.
+void addBorder(Hasher *h, const ChunkSnapshot *chunk, int s, int sliceX, int sliceZ) {
+    if(chunk == nullptr) {
+        h->add(MISSING_TAG);
+        return;
+    }
+    const ChunkSection &section = chunk->section(s);
+    if(section.isUniform()) {
+        h->add(UNIFORM_TAG);
+        h->add(section.get(0, 0, 0));
+        return;
+    }
+    std::array<BlockType, SECTION_HEIGHT * X_BOUND> slice;
+    for(int i = 0; i < X_BOUND; ++i) {
+        int x = sliceX >= 0 ? sliceX : i;
+        int z = sliceZ >= 0 ? sliceZ : i;
+        section.readColumn(x, z, 0, SECTION_HEIGHT - 1, &slice[i * SECTION_HEIGHT]);
+    }
+    h->add(BORDER_TAG);
+    h->add(slice.data(), slice.size());
+}
+
+}
+
+float MeshCacheStats::hitRate() const {
+    size_t lookups = memoryHits + diskHits + misses;
+    return lookups == 0 ? 0.f : static_cast<float>(memoryHits + diskHits) / lookups;
+}
+
+MeshCache::MeshCache(size_t maxBytes) :
+    m_entries(), m_index(), m_bytes(0), m_maxBytes(maxBytes), m_directory(),
+    m_files(), m_fileIndex(), m_diskBytes(0), m_maxDiskBytes(0), m_mutex(),
+    m_memoryHits(0), m_diskHits(0), m_misses(0)
+{}
+
+uint64_t MeshCache::keyOf(const MeshInput &input, MeshMode mode) {
+    Hasher h(MESH_FORMAT_VERSION);
+    h.add(mode);
+
+    // Air sections make no faces, and the mesher reads nothing around
+    // them, so only the others and the borders beside them count
+    const ChunkSnapshot &center = *input.center;
+    std::array<BlockType, SECTION_VOLUME> blocks;
+    for(int i = 0; i < static_cast<int>(center.sections.size()); ++i) {
+        const ChunkSection &section = *center.sections[i];
+        int s = center.minSection + i;
+        if(section.isUniform() && section.get(0, 0, 0) == EMPTY) {
+            continue;
+        }
+        h.add(SECTION_TAG);
+        h.add(s);
+        if(section.isUniform()) {
+            h.add(UNIFORM_TAG);
+            h.add(section.get(0, 0, 0));
+        } else {
+            for(int x = 0; x < X_BOUND; ++x) {
+                for(int z = 0; z < Z_BOUND; ++z) {
+                    section.readColumn(x, z, 0, SECTION_HEIGHT - 1,
+                                       &blocks[(x * Z_BOUND + z) * SECTION_HEIGHT]);
+                }
+            }
+            h.add(blocks.data(), blocks.size());
+        }
+        addBorder(&h, input.neighbors[XNEG].get(), s, X_BOUND - 1, -1);
+        addBorder(&h, input.neighbors[XPOS].get(), s, 0, -1);
+        addBorder(&h, input.neighbors[ZNEG].get(), s, -1, Z_BOUND - 1);
+        addBorder(&h, input.neighbors[ZPOS].get(), s, -1, 0);
+    }
+    return h.value();
+}
+
+uint64_t MeshCache::lodKeyOf(uint64_t key, int level, LodSampling sampling) {
+    Hasher h(key);
+    h.add(LOD_TAG);
+    h.add(level);
+    h.add(sampling);
+    return h.value();
+}
+
+bool MeshCache::lookup(uint64_t key, MeshBuffers *out) {
+    std::string dir;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_index.find(key);
+        if(it != m_index.end()) {
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            out->faces = it->second->faces;
+            out->transFaces = it->second->transFaces;
+            m_memoryHits++;
+            return true;
+        }
+        dir = m_directory;
+    }
+
+    if(readFile(dir, key, out)) {
+        // Files are evicted by age, so reading one makes it new again,
+        // in later sessions too
+        std::error_code error;
+        std::filesystem::last_write_time(pathOf(dir, key), std::filesystem::file_time_type::clock::now(), error);
+        QMutexLocker locker(&m_mutex);
+        insert(key, out->faces, out->transFaces);
+        auto file = m_fileIndex.find(key);
+        if(dir == m_directory && file != m_fileIndex.end()) {
+            touchFile(key, file->second->bytes);
+        }
+        m_diskHits++;
+        return true;
+    }
+    m_misses++;
+    return false;
+}
+
+void MeshCache::store(uint64_t key, const MeshBuffers &mesh, bool persist) {
+    std::string dir;
+    {
+        QMutexLocker locker(&m_mutex);
+        insert(key, mesh.faces, mesh.transFaces);
+        dir = m_directory;
+    }
+    if(!persist) {
+        return;
+    }
+    size_t bytes = writeFile(dir, key, mesh);
+    QMutexLocker locker(&m_mutex);
+    // The directory may have changed while the file was written
+    if(bytes > 0 && dir == m_directory) {
+        touchFile(key, bytes);
+        evictFiles();
+    }
+}
+
+void MeshCache::insert(uint64_t key, const std::vector<ChunkFace> &faces,
+                       const std::vector<ChunkFace> &transFaces) {
+    size_t bytes = (faces.size() + transFaces.size()) * sizeof(ChunkFace);
+    if(m_index.find(key) != m_index.end() || bytes > m_maxBytes) {
+        return;
+    }
+    m_entries.push_front(Entry{key, faces, transFaces});
+    m_index[key] = m_entries.begin();
+    m_bytes += bytes;
+
+    while(m_bytes > m_maxBytes) {
+        const Entry &oldest = m_entries.back();
+        m_bytes -= (oldest.faces.size() + oldest.transFaces.size()) * sizeof(ChunkFace);
+        m_index.erase(oldest.key);
+        m_entries.pop_back();
+    }
+}
+
+void MeshCache::touchFile(uint64_t key, size_t bytes) {
+    auto file = m_fileIndex.find(key);
+    if(file != m_fileIndex.end()) {
+        m_diskBytes -= file->second->bytes;
+        m_files.erase(file->second);
+    }
+    m_files.push_front(DiskFile{key, bytes});
+    m_fileIndex[key] = m_files.begin();
+    m_diskBytes += bytes;
+}
+
+void MeshCache::evictFiles() {
+    while(m_diskBytes > m_maxDiskBytes && !m_files.empty()) {
+        const DiskFile &oldest = m_files.back();
+        std::error_code error;
+        std::filesystem::remove(pathOf(m_directory, oldest.key), error);
+        m_diskBytes -= oldest.bytes;
+        m_fileIndex.erase(oldest.key);
+        m_files.pop_back();
+    }
+}
+
+void MeshCache::setDirectory(const std::string &directory, size_t maxBytes) {
+    QMutexLocker locker(&m_mutex);
+    m_directory = directory;
+    m_maxDiskBytes = maxBytes;
+    m_files.clear();
+    m_fileIndex.clear();
+    m_diskBytes = 0;
+    if(directory.empty()) {
+        return;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    // Count the files earlier sessions left, so that the budget covers
+    // them too
+    struct Found {
+        std::filesystem::file_time_type time;
+        DiskFile file;
+    };
+    std::vector<Found> found;
+    for(std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        const std::filesystem::path &path = it->path();
+        std::string name = path.filename().string();
+        if(name.find(".tmp") != std::string::npos) {
+            // Half-written by a session that didn't finish
+            std::error_code removeError;
+            std::filesystem::remove(path, removeError);
+            continue;
+        }
+        char *keyEnd = nullptr;
+        std::string stem = path.stem().string();
+        uint64_t key = std::strtoull(stem.c_str(), &keyEnd, 16);
+        std::error_code statError;
+        size_t bytes = it->file_size(statError);
+        std::filesystem::file_time_type time = it->last_write_time(statError);
+        if(path.extension() != ".mesh" || *keyEnd != '\0' || statError) {
+            continue;
+        }
+        found.push_back(Found{time, DiskFile{key, bytes}});
+    }
+    std::sort(found.begin(), found.end(),
+              [](const Found &a, const Found &b) { return a.time < b.time; });
+    for(const Found &f : found) {
+        touchFile(f.file.key, f.file.bytes);
+    }
+    evictFiles();
+}
+
+std::string MeshCache::pathOf(const std::string &directory, uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.mesh", static_cast<unsigned long long>(key));
+    return directory + "/" + name;
+}
+
+bool MeshCache::readFile(const std::string &directory, uint64_t key, MeshBuffers *out) {
+    if(directory.empty()) {
+        return false;
+    }
+    std::ifstream file(pathOf(directory, key), std::ios::binary);
+    FileHeader header;
+    if(!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+       header.magic != MESH_FILE_MAGIC || header.version != MESH_FORMAT_VERSION || header.key != key ||
+       header.faceCount > MAX_FILE_FACES || header.transFaceCount > MAX_FILE_FACES) {
+        return false;
+    }
+    out->faces.resize(header.faceCount);
+    out->transFaces.resize(header.transFaceCount);
+    if(!file.read(reinterpret_cast<char*>(out->faces.data()), out->faces.size() * sizeof(ChunkFace)) ||
+       !file.read(reinterpret_cast<char*>(out->transFaces.data()), out->transFaces.size() * sizeof(ChunkFace))) {
+        out->clear();
+        return false;
+    }
+    return true;
+}
+
+size_t MeshCache::writeFile(const std::string &directory, uint64_t key, const MeshBuffers &mesh) {
+    if(directory.empty()) {
+        return 0;
+    }
+    // Written under a name of the thread's own and then renamed, so that
+    // a reader never sees half a file
+    std::string path = pathOf(directory, key);
+    std::string temp = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        FileHeader header{MESH_FILE_MAGIC, MESH_FORMAT_VERSION, key,
+                          static_cast<uint32_t>(mesh.faces.size()),
+                          static_cast<uint32_t>(mesh.transFaces.size())};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(mesh.faces.data()), mesh.faces.size() * sizeof(ChunkFace));
+        file.write(reinterpret_cast<const char*>(mesh.transFaces.data()), mesh.transFaces.size() * sizeof(ChunkFace));
+        if(!file) {
+            file.close();
+            std::remove(temp.c_str());
+            return 0;
+        }
+    }
+    if(std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return 0;
+    }
+    return sizeof(FileHeader) + (mesh.faces.size() + mesh.transFaces.size()) * sizeof(ChunkFace);
+}
+
+MeshCacheStats MeshCache::stats() const {
+    MeshCacheStats stats;
+    stats.memoryHits = m_memoryHits;
+    stats.diskHits = m_diskHits;
+    stats.misses = m_misses;
+    QMutexLocker locker(&m_mutex);
+    stats.entries = m_entries.size();
+    stats.memoryBytes = m_bytes;
+    stats.diskBytes = m_diskBytes;
+    return stats;
+}
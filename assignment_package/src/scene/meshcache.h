@@ -0,0 +1,102 @@
+#pragma once
+#include "chunkmesh.h"
+
+#include <QMutex>
+#include <atomic>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+// Counters describing a MeshCache since it was created
+struct MeshCacheStats {
+    size_t memoryHits;   // Meshes found in memory
+    size_t diskHits;     // Meshes loaded from the cache directory
+    size_t misses;       // Meshes that had to be built
+    size_t entries;      // Meshes currently held in memory
+    size_t memoryBytes;  // Bytes their faces use
+    size_t diskBytes;    // Bytes the cache directory's files use
+
+    // Share of lookups that skipped meshing, or 0 before any lookup
+    float hitRate() const;
+};
+
+// Finished Chunk meshes, keyed by a hash of everything the mesher reads
+// (see keyOf), so that a Chunk regenerated or reloaded with the same
+// blocks skips straight to upload. Recently used meshes are kept in
+// memory up to a byte budget; with a directory set, meshes of freshly
+// generated Chunks are also written there, one file each, and read back
+// in later sessions. The directory has a byte budget of its own, over
+// which the least recently written or read files are deleted. Safe to
+// use from any thread.
+class MeshCache {
+private:
+    struct Entry {
+        uint64_t key;
+        std::vector<ChunkFace> faces;
+        std::vector<ChunkFace> transFaces;
+    };
+
+    // Most recently used first, plus each key's position in that list
+    std::list<Entry> m_entries;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> m_index;
+    size_t m_bytes;
+    size_t m_maxBytes;
+    std::string m_directory;
+
+    // The cache directory's files, most recently written or read first,
+    // plus each key's position in that list
+    struct DiskFile {
+        uint64_t key;
+        size_t bytes;
+    };
+    std::list<DiskFile> m_files;
+    std::unordered_map<uint64_t, std::list<DiskFile>::iterator> m_fileIndex;
+    size_t m_diskBytes;
+    size_t m_maxDiskBytes;
+    mutable QMutex m_mutex;
+
+    std::atomic<size_t> m_memoryHits;
+    std::atomic<size_t> m_diskHits;
+    std::atomic<size_t> m_misses;
+
+    // Adds an entry, evicting the least recently used ones over budget.
+    // Must be called with m_mutex held.
+    void insert(uint64_t key, const std::vector<ChunkFace> &faces,
+                const std::vector<ChunkFace> &transFaces);
+    // Records that the file of the given key was just written or read.
+    // Must be called with m_mutex held.
+    void touchFile(uint64_t key, size_t bytes);
+    // Deletes the least recently used files over the directory's budget.
+    // Must be called with m_mutex held.
+    void evictFiles();
+    static std::string pathOf(const std::string &directory, uint64_t key);
+    static bool readFile(const std::string &directory, uint64_t key, MeshBuffers *out);
+    // Returns the size of the file written, or 0 if it couldn't be
+    static size_t writeFile(const std::string &directory, uint64_t key, const MeshBuffers &mesh);
+
+public:
+    explicit MeshCache(size_t maxBytes = 64 << 20);
+
+    // Hash of the blocks of input's center Chunk and of the neighbours'
+    // blocks along its sides, plus the mode and the ChunkFace format.
+    // Equal keys mean equal meshes. The reverse only fails for a section
+    // holding one type that has not been compacted into a uniform one.
+    static uint64_t keyOf(const MeshInput &input, MeshMode mode);
+    // Key of the given level of detail of the Chunk whose full mesh has
+    // the given key
+    static uint64_t lodKeyOf(uint64_t key, int level, LodSampling sampling);
+
+    // Copies the mesh with the given key into out and returns true, or
+    // returns false if there is none
+    bool lookup(uint64_t key, MeshBuffers *out);
+    // Remembers mesh under the given key. persist also writes it to the
+    // cache directory, if there is one.
+    void store(uint64_t key, const MeshBuffers &mesh, bool persist);
+
+    // Where meshes are saved between sessions, and how many bytes of
+    // files may be kept there. Empty (the default) keeps them in memory
+    // only. The directory is created if needed; files already in it
+    // count towards the budget, oldest first.
+    void setDirectory(const std::string &directory, size_t maxBytes = 256 << 20);
+    MeshCacheStats stats() const;
+};
@@ -158,7 +158,7 @@ float NoiseFunction::perlinNoise3D(glm::vec3 p) {
     return surfletSum;
 }
 
-void NoiseFunction::drawRiver(Chunk *cPtr){
+void NoiseFunction::drawRiver(ChunkData *cPtr){
 
     int x_min = 0;
     int x_max = X_BOUND;
@@ -185,11 +185,6 @@ void NoiseFunction::drawRiver(Chunk *cPtr){
                    z1+i*dz < z_max &&
                    z1+i*dz > z_min) {
 
-                    int h = 128;
-
-                    while (cPtr->getBlockAt(x1+i*dx, h, z1+i*dz) != EMPTY && h != 256)
-                        h++;
-
                     for(int j = 0; j <= w; j++) {
                         if(x1+i*dx+j < x_max &&
                            x1+i*dx+j > x_min &&
@@ -199,11 +194,9 @@ void NoiseFunction::drawRiver(Chunk *cPtr){
                             cPtr->setBlockAt(x1+i*dx+j, 128, z1+i*dz, WATER);
                             cPtr->setBlockAt(x1+i*dx, 128, z1+i*dz+j, WATER);
                             cPtr->setBlockAt(x1+i*dx+j, 128, z1+i*dz+j, WATER);
-                            for(int y = 129; y < 256; y++) {
-                                cPtr->setBlockAt(x1+i*dx+j, y, z1+i*dz, EMPTY);
-                                cPtr->setBlockAt(x1+i*dx, y, z1+i*dz+j, EMPTY);
-                                cPtr->setBlockAt(x1+i*dx+j, y, z1+i*dz+j, EMPTY);
-                            }
+                            cPtr->fillColumn(x1+i*dx+j, z1+i*dz, 129, 255, EMPTY);
+                            cPtr->fillColumn(x1+i*dx, z1+i*dz+j, 129, 255, EMPTY);
+                            cPtr->fillColumn(x1+i*dx+j, z1+i*dz+j, 129, 255, EMPTY);
                         }
                     }
                 }
@@ -232,7 +225,9 @@ BlockType NoiseFunction::biomeBlock(glm::vec3 p, Biomes b, glm::vec2 noise, std:
             if(secondaryBiome < 60.f){
                 float dist = 20.f - (secondaryBiome - primaryBiome);
                 float prob = glm::smoothstep(0.f, 64.f, dist);
-                float r = (rand() % 100 / 99.f);
+                // Hashed from the column rather than drawn from rand(),
+                // so that a column generated again comes out the same
+                float r = random3(glm::vec3(p.x, p.y, i + 3 * j)).x;
                 if(r < prob) b = b_n;
             }
 
@@ -3,7 +3,7 @@
 
 #include "glm_includes.h"
 #include <stdexcept>
-#include "chunk.h"
+#include "chunkdata.h"
 #include "river.h"
 #include "terrain.h"
 
@@ -28,7 +28,7 @@ public:
     float surflet3D(glm::vec3 p, glm::vec3 gridPoint);
     float perlinNoise3D(glm::vec3 p);
 
-    void drawRiver(Chunk *cPtr);
+    void drawRiver(ChunkData *cPtr);
 
     float biomeHeight(glm::vec2 p);
     BlockType biomeBlock(glm::vec3 p, Biomes b, glm::vec2 noise, std::unordered_map<int64_t, std::pair<glm::vec2, Biomes>> biomeMap);
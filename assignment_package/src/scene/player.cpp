@@ -77,26 +77,31 @@ void Player::computePhysics(float dT, const Terrain &terrain) {
 
     if (!flightMode) {
         glm::ivec3 currCell = glm::ivec3(glm::floor(m_position));
-        try {
-            //check if on the ground
-            BlockType cellType = terrain.getBlockAt(currCell.x, currCell.y - 1, currCell.z);
-            if(cellType == EMPTY) {
-                m_acceleration.y -= gravityScale;
-                m_velocity = m_acceleration * dT;
-                pos = m_velocity * dT;
-            }
-        } catch (const std::out_of_range& e) {
-            //std::cout << "chunk out of range"<< "\n";
+        //check if on the ground (the Player doesn't fall in
+        //terrain that hasn't been generated yet)
+        if(terrain.isGeneratedAt(currCell.x, currCell.y - 1, currCell.z) &&
+           !terrain.isOccupiedAt(currCell.x, currCell.y - 1, currCell.z)) {
+            m_acceleration.y -= gravityScale;
+            m_velocity = m_acceleration * dT;
+            pos = m_velocity * dT;
         }
         float minDist = FLT_MAX;
-        for (float i = -0.5; i <= 0.5; i++) {
-            for (int j = 0; j <= 2; j++) {
-                for (float k = -0.5; k <= 0.5; k++) {
-                    float outDist = 0.f;
-                    glm::ivec3 outBlockHit(0, 0, 0);
-                    glm::vec3 rayOrigin = glm::vec3(m_position.x + i, m_position.y + j, m_position.z + k);
-                    if (gridMarch(rayOrigin, pos, terrain, &outDist, &outBlockHit)) {
-                        minDist = glm::min(minDist, outDist);
+        //the rays can only hit blocks in the box swept by the Player,
+        //so when that box is all air they can be skipped
+        glm::vec3 lo = m_position + glm::vec3(-0.5f, 0.f, -0.5f);
+        glm::vec3 hi = m_position + glm::vec3(0.5f, 2.f, 0.5f);
+        glm::ivec3 sweptMin = glm::ivec3(glm::floor(glm::min(lo, lo + pos))) - 1;
+        glm::ivec3 sweptMax = glm::ivec3(glm::floor(glm::max(hi, hi + pos))) + 1;
+        if (terrain.anyOccupiedInBox(sweptMin, sweptMax)) {
+            for (float i = -0.5; i <= 0.5; i++) {
+                for (int j = 0; j <= 2; j++) {
+                    for (float k = -0.5; k <= 0.5; k++) {
+                        float outDist = 0.f;
+                        glm::ivec3 outBlockHit(0, 0, 0);
+                        glm::vec3 rayOrigin = glm::vec3(m_position.x + i, m_position.y + j, m_position.z + k);
+                        if (gridMarch(rayOrigin, pos, terrain, &outDist, &outBlockHit)) {
+                            minDist = glm::min(minDist, outDist);
+                        }
                     }
                 }
             }
@@ -113,53 +118,44 @@ void Player::computePhysics(float dT, const Terrain &terrain) {
     this->moveAlongVector(pos);
 }
 
-void Player::removeBlock() {
+void Player::removeBlock(Terrain &terrain) {
     float outDist = 0.f;
     glm::ivec3 outBlockHit(0, 0, 0);
 
-    if (gridMarch(mcr_camera.mcr_position, 3.f * m_forward, mcr_terrain, &outDist, &outBlockHit)) {
-        int xPos = outBlockHit.x % X_BOUND;
-        int yPos = outBlockHit.y % Y_BOUND;
-        int zPos = outBlockHit.z % Z_BOUND;
-        mcr_terrain.getChunkAt(outBlockHit.x, outBlockHit.z)->setBlockAt(xPos, yPos, zPos, EMPTY);
+    if (terrain.raycast(mcr_camera.mcr_position, m_forward, 3.f, &outDist, &outBlockHit)) {
+        terrain.editBlockAt(outBlockHit.x, outBlockHit.y, outBlockHit.z, EMPTY);
     }
 }
 
-void Player::addBlock() {
+void Player::addBlock(Terrain &terrain) {
     float outDist = 0.f;
     glm::ivec3 outBlockHit(0, 0, 0);
-    glm::vec3 intersection(0, 0, 0);
-    if (gridMarch(mcr_camera.mcr_position, 3.f * m_forward, mcr_terrain, &outDist, &outBlockHit, &intersection)) {
-        if (intersection.x - outBlockHit.x == 1.f) {
-            outBlockHit.x +=1;
-        } else if (intersection.y - outBlockHit.y == 1.f) {
-            outBlockHit.y +=1;
-        } else if (intersection.z - outBlockHit.z == 1.f) {
-            outBlockHit.z +=1;
-        }
+    glm::ivec3 normal(0, 0, 0);
+    if (terrain.raycast(mcr_camera.mcr_position, m_forward, 3.f, &outDist, &outBlockHit, &normal)) {
+        // The new block goes against the face that was looked at
+        outBlockHit += normal;
     } else {
         glm::vec3 pos = mcr_camera.mcr_position + 3.f * m_forward;
         outBlockHit = glm::ivec3(glm::floor(pos));
     }
-    int xPos = outBlockHit.x % X_BOUND;
-    int yPos = outBlockHit.y % Y_BOUND;
-    int zPos = outBlockHit.z % Z_BOUND;
-    if (mcr_terrain.getBlockAt(outBlockHit.x, outBlockHit.y, outBlockHit.z) == EMPTY) {
-        mcr_terrain.getChunkAt(outBlockHit.x, outBlockHit.z)->setBlockAt(xPos, yPos, zPos, WATER);
+    if (terrain.getBlockAt(outBlockHit.x, outBlockHit.y, outBlockHit.z) == EMPTY) {
+        terrain.editBlockAt(outBlockHit.x, outBlockHit.y, outBlockHit.z, WATER);
     }
 
 }
 
 bool Player::gridMarch(glm::vec3 rayOrigin, glm::vec3 rayDirection,
                        const Terrain &terrain, float *outDist, glm::ivec3 *outBlockHit) {
-    glm::vec3 intersection(0, 0, 0);
-    return gridMarch(rayOrigin, rayDirection, terrain, outDist, outBlockHit, &intersection);
-}
-
-bool Player::gridMarch(glm::vec3 rayOrigin, glm::vec3 rayDirection,
-                       const Terrain &terrain, float *outDist, glm::ivec3 *outBlockHit,
-                       glm::vec3 *intersection) {
     float maxLen = glm::length(rayDirection); // Farthest we search
+    // Every cell the march visits lies within a block of the box around
+    // the ray, so if that holds nothing (say, it only covers sections
+    // that are all air or not generated) there is nothing to hit
+    glm::vec3 rayEnd = rayOrigin + rayDirection;
+    if(!terrain.anyOccupiedInBox(glm::ivec3(glm::floor(glm::min(rayOrigin, rayEnd))) - 1,
+                                 glm::ivec3(glm::floor(glm::max(rayOrigin, rayEnd))) + 1)) {
+        *outDist = maxLen;
+        return false;
+    }
     glm::ivec3 currCell = glm::ivec3(glm::floor(rayOrigin));
     rayDirection = glm::normalize(rayDirection); // Now all t values represent world dist.
 
@@ -195,20 +191,16 @@ bool Player::gridMarch(glm::vec3 rayOrigin, glm::vec3 rayDirection,
         currCell = glm::ivec3(glm::floor(rayOrigin)) + offset;
         // If currCell contains something other than EMPTY, return
         // curr_t
-        try {
-            BlockType cellType = terrain.getBlockAt(currCell.x, currCell.y, currCell.z);
-            if(cellType != EMPTY) {
-                *outBlockHit = currCell;
-                if (cellType == WATER || cellType == LAVA) {
-                    *outDist = 0.67 * glm::min(maxLen, curr_t);
-                } else {
-                    *outDist = glm::min(maxLen, curr_t);
-                }
-                *intersection = rayOrigin;
-                return true;
+        Collision collision = terrain.collisionAt(currCell.x, currCell.y, currCell.z);
+        if(collision != Collision::NONE) {
+            *outBlockHit = currCell;
+            // Liquids only slow the Player down
+            if (collision == Collision::LIQUID) {
+                *outDist = 0.67 * glm::min(maxLen, curr_t);
+            } else {
+                *outDist = glm::min(maxLen, curr_t);
             }
-        } catch (const std::out_of_range& e) {
-            //std::cout << "chunk out of range"<< "\n";
+            return true;
         }
 
     }
@@ -16,9 +16,6 @@ private:
 
     bool gridMarch(glm::vec3 rayOrigin, glm::vec3 rayDirection, const Terrain &terrain,
                    float *outDist, glm::ivec3 *outBlockHit);
-    // for adding block feature to detect adj face
-    bool gridMarch(glm::vec3 rayOrigin, glm::vec3 rayDirection, const Terrain &terrain,
-                   float *outDist, glm::ivec3 *outBlockHit, glm::vec3 *intersection);
 public:
     // Readonly public reference to our camera
     // for easy access from MyGL
@@ -30,8 +27,9 @@ public:
     void setCameraWidthHeight(unsigned int w, unsigned int h);
 
     void tick(float dT, InputBundle &input) override;
-    void removeBlock();
-    void addBlock();
+    // Edits go through the Terrain so that the changed Chunks are remeshed
+    void removeBlock(Terrain &terrain);
+    void addBlock(Terrain &terrain);
 
     // Player overrides all of Entity's movement
     // functions so that it transforms its camera
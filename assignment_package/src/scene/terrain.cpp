@@ -1,12 +1,18 @@
 #include "terrain.h"
 #include "cube.h"
-#include "chunk.h"
+#include "chunkdata.h"
 #include "noisefunctions.h"
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 
 Terrain::Terrain(OpenGLContext *context)
-    : m_chunks(), m_generatedTerrain(), mp_context(context)
+    : m_chunks(), m_meshes(), m_generatedTerrain(), mp_context(context),
+      m_zoneLRU(), m_zoneLRUPos(), m_residentRadius(4), m_persistenceHook(),
+      m_frozenZones(), m_trees(), m_dirtyChunks(), m_remeshingChunks(), m_staleLods(),
+      m_meshMode(GREEDY), m_quadIndices(context), m_lodMeshes(), m_lodRings{{2, 4, 8}},
+      m_lodSampling(TOP_SURFACE), m_viewDistance(2), m_verticalRadius(8),
+      m_zoneSections(), m_extendingZones()
 {}
 
 Terrain::~Terrain() {
@@ -52,13 +58,13 @@ BlockType Terrain::getBlockAt(int x, int y, int z) const
     if(hasChunkAt(x, z)) {
         // Just disallow action below or above min/max height,
         // but don't crash the game over it.
-        if(y < 0 || y >= 256) {
+        if(y < WORLD_MIN_Y || y >= WORLD_MAX_Y) {
             return EMPTY;
         }
-        const uPtr<Chunk> &c = getChunkAt(x, z);
+        const uPtr<ChunkData> &c = getChunkAt(x, z);
         glm::vec2 chunkOrigin = glm::vec2(floor(x / 16.f) * 16, floor(z / 16.f) * 16);
         return c->getBlockAt(static_cast<unsigned int>(x - chunkOrigin.x),
-                             static_cast<unsigned int>(y),
+                             y,
                              static_cast<unsigned int>(z - chunkOrigin.y));
     }
     else {
@@ -72,6 +78,178 @@ BlockType Terrain::getBlockAt(glm::vec3 p) const {
     return getBlockAt(p.x, p.y, p.z);
 }
 
+// Like getBlockAt, throws std::out_of_range if there is no Chunk at x, z
+int Terrain::getSurfaceHeight(int x, int z) const
+{
+    if(hasChunkAt(x, z)) {
+        const uPtr<ChunkData> &c = getChunkAt(x, z);
+        glm::vec2 chunkOrigin = glm::vec2(floor(x / 16.f) * 16, floor(z / 16.f) * 16);
+        return c->getSurfaceHeight(static_cast<unsigned int>(x - chunkOrigin.x),
+                                   static_cast<unsigned int>(z - chunkOrigin.y));
+    }
+    else {
+        throw std::out_of_range("Coordinates " + std::to_string(x) +
+                                " " + std::to_string(z) + " have no Chunk!");
+    }
+}
+
+BlockType Terrain::getSurfaceBlock(int x, int z) const
+{
+    int h = getSurfaceHeight(x, z);
+    return h == NO_SURFACE ? EMPTY : getBlockAt(x, h, z);
+}
+
+int Terrain::grassHeight(int x, int z) const
+{
+    int h = getSurfaceHeight(x, z);
+    return (h >= 128 && getSurfaceBlock(x, z) == GRASS) ? h : 256;
+}
+
+const ChunkData *Terrain::findChunk(int x, int z) const {
+    // Masking off the low bits floors negative coordinates correctly too
+    auto c = m_chunks.find(toKey(x & ~(X_BOUND - 1), z & ~(Z_BOUND - 1)));
+    return c == m_chunks.end() ? nullptr : c->second.get();
+}
+
+ChunkData *Terrain::findChunk(int x, int z) {
+    auto c = m_chunks.find(toKey(x & ~(X_BOUND - 1), z & ~(Z_BOUND - 1)));
+    return c == m_chunks.end() ? nullptr : c->second.get();
+}
+
+const ChunkTree *Terrain::findTree(int x, int z) const {
+    auto t = m_trees.find(toKey(x & ~(X_BOUND - 1), z & ~(Z_BOUND - 1)));
+    return t == m_trees.end() ? nullptr : t->second.get();
+}
+
+bool Terrain::isOpaqueAt(int x, int y, int z) const {
+    // Far Chunks answer from their tree so that they stay frozen
+    const ChunkTree *tree = findTree(x, z);
+    if(tree != nullptr) {
+        return tree->isOpaqueAt(x & (X_BOUND - 1), y, z & (Z_BOUND - 1));
+    }
+    const ChunkData *c = findChunk(x, z);
+    return c != nullptr && c->isOpaqueAt(x & (X_BOUND - 1), y, z & (Z_BOUND - 1));
+}
+
+bool Terrain::isOccupiedAt(int x, int y, int z) const {
+    const ChunkTree *tree = findTree(x, z);
+    if(tree != nullptr) {
+        return tree->isOccupiedAt(x & (X_BOUND - 1), y, z & (Z_BOUND - 1));
+    }
+    const ChunkData *c = findChunk(x, z);
+    return c != nullptr && c->isOccupiedAt(x & (X_BOUND - 1), y, z & (Z_BOUND - 1));
+}
+
+// Every opaque block is solid and every transparent one liquid (checked
+// where BLOCK_INFO is defined), so the masks answer this without
+// reading the block's type
+bool Terrain::isGeneratedAt(int x, int y, int z) const {
+    if(!hasChunkAt(x, z) || y < WORLD_MIN_Y || y >= WORLD_MAX_Y) {
+        return false;
+    }
+    auto sections = m_zoneSections.find(toKey(static_cast<int>(glm::floor(x / 64.f)) * 64,
+                                              static_cast<int>(glm::floor(z / 64.f)) * 64));
+    return sections != m_zoneSections.end() &&
+           sectionOf(y) >= sections->second.x && sectionOf(y) <= sections->second.y;
+}
+
+Collision Terrain::collisionAt(int x, int y, int z) const {
+    if(!isOccupiedAt(x, y, z)) {
+        return Collision::NONE;
+    }
+    return isOpaqueAt(x, y, z) ? Collision::SOLID : Collision::LIQUID;
+}
+
+int Terrain::emptyCubeSize(glm::ivec3 p) const {
+    const ChunkData *c = findChunk(p.x, p.z);
+    if(c == nullptr) {
+        return SECTION_HEIGHT;
+    }
+    glm::ivec3 local(p.x & (X_BOUND - 1), p.y, p.z & (Z_BOUND - 1));
+    const ChunkTree *tree = findTree(p.x, p.z);
+    if(tree != nullptr) {
+        if(!tree->isSectionOccupied(local.y)) {
+            return SECTION_HEIGHT;
+        }
+        if(!tree->isBrickOccupied(local.x, local.y, local.z)) {
+            return 4;
+        }
+        return tree->isOccupiedAt(local.x, local.y, local.z) ? 0 : 1;
+    }
+    glm::ivec3 section = local & ~(SECTION_HEIGHT - 1);
+    if(!c->anyOccupiedInBox(section, section + (SECTION_HEIGHT - 1))) {
+        return SECTION_HEIGHT;
+    }
+    glm::ivec3 brick = local & ~3;
+    if(!c->anyOccupiedInBox(brick, brick + 3)) {
+        return 4;
+    }
+    return c->isOccupiedAt(local.x, local.y, local.z) ? 0 : 1;
+}
+
+bool Terrain::raycast(glm::vec3 origin, glm::vec3 direction, float maxDist,
+                      float *outDist, glm::ivec3 *outBlockHit, glm::ivec3 *outNormal) const {
+    glm::vec3 dir = glm::normalize(direction);
+    glm::ivec3 start(glm::floor(origin));
+    // The axis of the last cube boundary crossed
+    int axis = -1;
+    float t = 0.f;
+    while(t < maxDist) {
+        glm::ivec3 cell(glm::floor(origin + t * dir));
+        // Nothing lies beyond the top or bottom of the world
+        if((cell.y < WORLD_MIN_Y && dir.y <= 0.f) || (cell.y >= WORLD_MAX_Y && dir.y >= 0.f)) {
+            return false;
+        }
+        int size = emptyCubeSize(cell);
+        if(size == 0 && cell == start) {
+            size = 1;
+        }
+        if(size == 0) {
+            *outDist = t;
+            *outBlockHit = cell;
+            if(outNormal != nullptr) {
+                *outNormal = glm::ivec3(0);
+                if(axis != -1) {
+                    (*outNormal)[axis] = dir[axis] > 0.f ? -1 : 1;
+                }
+            }
+            return true;
+        }
+
+        // Skip to where the ray leaves the empty cube. All of the cube
+        // sizes are powers of two, and the world's bounds are multiples
+        // of all of them, so masking finds the cube's lower corner.
+        glm::ivec3 lo = cell & ~(size - 1);
+        float exit = maxDist;
+        for(int i = 0; i < 3; ++i) {
+            if(dir[i] != 0.f) {
+                float bound = dir[i] > 0.f ? lo[i] + size : lo[i];
+                float axisExit = (bound - origin[i]) / dir[i];
+                if(axisExit < exit) {
+                    exit = axisExit;
+                    axis = i;
+                }
+            }
+        }
+        // Nudge past the boundary so the next cell is the one beyond it
+        t = glm::max(exit, t) + 1e-4f;
+    }
+    return false;
+}
+
+bool Terrain::anyOccupiedInBox(glm::ivec3 min, glm::ivec3 max) const {
+    for(int cx = min.x & ~(X_BOUND - 1); cx <= max.x; cx += X_BOUND) {
+        for(int cz = min.z & ~(Z_BOUND - 1); cz <= max.z; cz += Z_BOUND) {
+            const ChunkData *c = findChunk(cx, cz);
+            glm::ivec3 origin(cx, 0, cz);
+            if(c != nullptr && c->anyOccupiedInBox(min - origin, max - origin)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 bool Terrain::hasChunkAt(int x, int z) const {
     /*
      * Map x and z to their nearest Chunk corner
@@ -88,14 +266,14 @@ bool Terrain::hasChunkAt(int x, int z) const {
 }
 
 
-uPtr<Chunk>& Terrain::getChunkAt(int x, int z) {
+uPtr<ChunkData>& Terrain::getChunkAt(int x, int z) {
     int xFloor = static_cast<int>(glm::floor(x / 16.f));
     int zFloor = static_cast<int>(glm::floor(z / 16.f));
     return m_chunks[toKey(16 * xFloor, 16 * zFloor)];
 }
 
 
-const uPtr<Chunk>& Terrain::getChunkAt(int x, int z) const {
+const uPtr<ChunkData>& Terrain::getChunkAt(int x, int z) const {
     int xFloor = static_cast<int>(glm::floor(x / 16.f));
     int zFloor = static_cast<int>(glm::floor(z / 16.f));
     return m_chunks.at(toKey(16 * xFloor, 16 * zFloor));
@@ -104,12 +282,13 @@ const uPtr<Chunk>& Terrain::getChunkAt(int x, int z) const {
 void Terrain::setBlockAt(int x, int y, int z, BlockType t)
 {
     if(hasChunkAt(x, z)) {
-        uPtr<Chunk> &c = getChunkAt(x, z);
+        uPtr<ChunkData> &c = getChunkAt(x, z);
         glm::vec2 chunkOrigin = glm::vec2(floor(x / 16.f) * 16, floor(z / 16.f) * 16);
         c->setBlockAt(static_cast<unsigned int>(x - chunkOrigin.x),
-                      static_cast<unsigned int>(y),
+                      y,
                       static_cast<unsigned int>(z - chunkOrigin.y),
                       t);
+        m_trees.erase(toKey(c->getWorldSpaceX(), c->getWorldSpaceZ()));
     }
     else {
         throw std::out_of_range("Coordinates " + std::to_string(x) +
@@ -118,13 +297,91 @@ void Terrain::setBlockAt(int x, int y, int z, BlockType t)
     }
 }
 
-Chunk* Terrain::instantiateChunkAt(int x, int z) {
+void Terrain::fillColumn(int x, int z, int yMin, int yMax, BlockType t) {
+    fillBox(glm::ivec3(x, yMin, z), glm::ivec3(x, yMax, z), t);
+}
+
+void Terrain::fillBox(glm::ivec3 min, glm::ivec3 max, BlockType t) {
+    for(int cx = min.x & ~(X_BOUND - 1); cx <= max.x; cx += X_BOUND) {
+        for(int cz = min.z & ~(Z_BOUND - 1); cz <= max.z; cz += Z_BOUND) {
+            ChunkData *c = findChunk(cx, cz);
+            if(c == nullptr) {
+                continue;
+            }
+            glm::ivec3 origin(cx, 0, cz);
+            c->fillBox(min - origin, max - origin, t);
+            m_trees.erase(toKey(cx, cz));
+        }
+    }
+}
+
+void Terrain::readSpan(int x, int z, int yMin, int yMax, BlockType *out) const {
+    const ChunkData *c = findChunk(x, z);
+    if(c == nullptr) {
+        std::fill_n(out, glm::max(yMax - yMin + 1, 0), EMPTY);
+        return;
+    }
+    c->readSpan(x & (X_BOUND - 1), z & (Z_BOUND - 1), yMin, yMax, out);
+}
+
+void Terrain::copyRegion(glm::ivec3 srcMin, glm::ivec3 srcMax, glm::ivec3 dstMin) {
+    glm::ivec3 size = srcMax - srcMin + 1;
+    if(glm::any(glm::lessThanEqual(size, glm::ivec3(0)))) {
+        return;
+    }
+    // Read everything before writing anything, in case the boxes overlap
+    std::vector<BlockType> blocks(size.x * size.y * size.z);
+    for(int x = 0; x < size.x; ++x) {
+        for(int z = 0; z < size.z; ++z) {
+            readSpan(srcMin.x + x, srcMin.z + z, srcMin.y, srcMax.y,
+                     &blocks[(x * size.z + z) * size.y]);
+        }
+    }
+    for(int x = 0; x < size.x; ++x) {
+        for(int z = 0; z < size.z; ++z) {
+            int wx = dstMin.x + x, wz = dstMin.z + z;
+            ChunkData *c = findChunk(wx, wz);
+            if(c == nullptr) {
+                continue;
+            }
+            c->writeSpan(wx & (X_BOUND - 1), wz & (Z_BOUND - 1), dstMin.y, size.y,
+                         &blocks[(x * size.z + z) * size.y]);
+            m_trees.erase(toKey(wx & ~(X_BOUND - 1), wz & ~(Z_BOUND - 1)));
+        }
+    }
+}
+
+void Terrain::editBlockAt(int x, int y, int z, BlockType t) {
+    setBlockAt(x, y, z, t);
+    ChunkData *chunk = getChunkAt(x, z).get();
+    chunk->markEdited();
+    chunk->publish();
+    m_dirtyChunks.insert(chunk);
+
+    // A block on the Chunk's border also hides or exposes a face of
+    // the neighbouring Chunk
+    const std::array<glm::ivec2, 4> offsets {
+        glm::ivec2(1, 0), glm::ivec2(-1, 0), glm::ivec2(0, 1), glm::ivec2(0, -1)
+    };
+    for(const glm::ivec2 &offset : offsets) {
+        if(!hasChunkAt(x + offset.x, z + offset.y)) {
+            continue;
+        }
+        ChunkData *neighbor = getChunkAt(x + offset.x, z + offset.y).get();
+        if(neighbor != chunk) {
+            neighbor->markDirty(y);
+            m_dirtyChunks.insert(neighbor);
+        }
+    }
+}
+
+ChunkData* Terrain::instantiateChunkAt(int x, int z) {
 
     if(hasChunkAt(x, z))
         return nullptr;
 
-    uPtr<Chunk> chunk = mkU<Chunk>(mp_context, x, z);
-    Chunk *cPtr = chunk.get();
+    uPtr<ChunkData> chunk = mkU<ChunkData>(x, z);
+    ChunkData *cPtr = chunk.get();
 
 
     m_chunks[toKey(x, z)] = move(chunk);
@@ -153,19 +410,30 @@ Chunk* Terrain::instantiateChunkAt(int x, int z) {
  * Draws each Chunk with the given ShaderProgram, remembering to set the
  * model matrix to the proper X and Z translation!
  */
-void Terrain::draw(int minX, int maxX, int minZ, int maxZ, ShaderProgram *shaderProgram) {
+void Terrain::draw(int minX, int maxX, int minY, int maxY, int minZ, int maxZ,
+                   ShaderProgram *shaderProgram) {
+    if(m_quadIndices.elemCount() < 0) {
+        m_quadIndices.create();
+    }
+    int minSection = sectionOf(glm::clamp(minY, WORLD_MIN_Y, WORLD_MAX_Y - 1));
+    int maxSection = sectionOf(glm::clamp(maxY - 1, WORLD_MIN_Y, WORLD_MAX_Y - 1));
+    int centerX = static_cast<int>(glm::floor((minX + maxX) / 2.f / X_BOUND)) * X_BOUND;
+    int centerZ = static_cast<int>(glm::floor((minZ + maxZ) / 2.f / Z_BOUND)) * Z_BOUND;
     for(int x = minX; x < maxX; x += 16) {
         for(int z = minZ; z < maxZ; z += 16) {
 
             if(hasChunkAt(x, z)) {
 
-                const uPtr<Chunk> &chunk = getChunkAt(x, z);
-
-                if(chunk->elemCount() < 0) chunk->create();
+                int distance = std::max(std::abs(x - centerX) / X_BOUND,
+                                        std::abs(z - centerZ) / Z_BOUND);
+                ChunkMesh *mesh = meshAtLevel(getChunkAt(x, z).get(), lodLevel(distance));
+                if(mesh == nullptr) {
+                    continue;
+                }
 
                 shaderProgram->setModelMatrix(glm::translate(glm::mat4(), glm::vec3(x, 0, z)));
-                shaderProgram->drawChunk(*chunk);
-                shaderProgram->drawTransChunk(*chunk);
+                shaderProgram->drawChunk(*mesh, m_quadIndices, minSection, maxSection);
+                shaderProgram->drawTransChunk(*mesh, m_quadIndices, minSection, maxSection);
             }
         }
     }
@@ -196,6 +464,8 @@ void Terrain::CreateTestScene()
      * now exists.
      */
     m_generatedTerrain.insert(toKey(0, 0));
+    m_zoneSections[toKey(0, 0)] = glm::ivec2(sectionOf(0), sectionOf(Y_BOUND - 1));
+    touchZone(toKey(0, 0));
 
     for(int x = xmin; x < xmax; x++) {
         for(int z = zmin; z < zmax; z++) {
@@ -212,9 +482,7 @@ void Terrain::CreateTestScene()
             float t = abs(nf->perlinNoise(glm::vec2(abs(x)/(float)xmax, abs(z)/(float)zmax)));
             float s = glm::smoothstep(0.25f, 0.75f, 2 * t);
             float l = (1-s)*g+s*m;
-            for(int y = 0; y < 128; ++y) {
-                setBlockAt(x, y, z, STONE);
-            }
+            fillColumn(x, z, 0, 127, STONE);
             for(int y = 128; y < 256; ++y) {
                 if (s > 0.9) {
                     if (y < m) {
@@ -256,94 +524,70 @@ void Terrain::CreateTestScene()
         for(int z = zmin; z < zmax; z++) {
             if (getBlockAt(x, 128, z) == WATER) {
                 int dx = 0;
-                int hxp = 128;
                 while (x+dx < xmax && dx != 6) dx++;
-                while (getBlockAt(x+dx-1, hxp, z) != GRASS && hxp != 256) hxp++;
+                int hxp = grassHeight(x+dx-1, z);
                 for (int i = 1; i < dx-1; i++) {
-                    int h = 128;
-                    while (getBlockAt(x+i, h, z) != GRASS && h != 256) h++;
+                    int h = grassHeight(x+i, z);
                     if (hxp > 135) {
                         if (h != 256 && h > 128+2*i) {
                             setBlockAt(x+i, 128+2*i, z, GRASS);
-                            for (int j = 129+2*i; j < 256; j++) {
-                                setBlockAt(x+i, j, z, EMPTY);
-                            }
+                            fillColumn(x+i, z, 129+2*i, 255, EMPTY);
                         }
                     } else {
                         if (h != 256 && h > 128+i) {
                             setBlockAt(x+i, 128+i, z, GRASS);
-                            for (int j = 129+i; j < 256; j++) {
-                                setBlockAt(x+i, j, z, EMPTY);
-                            }
+                            fillColumn(x+i, z, 129+i, 255, EMPTY);
                         }
                     }
                 }
                 dx = 0;
-                hxp = 128;
                 while (x-dx > xmin && dx != 6) dx++;
-                while (getBlockAt(x-dx+1, hxp, z) != GRASS && hxp != 256) hxp++;
+                hxp = grassHeight(x-dx+1, z);
                 for (int i = 1; i < dx-1; i++) {
-                    int h = 128;
-                    while (getBlockAt(x-i, h, z) != GRASS && h != 256) h++;
+                    int h = grassHeight(x-i, z);
                     if (hxp > 135) {
                         if (h != 256 && h > 128+2*i) {
                             setBlockAt(x-i, 128+2*i, z, GRASS);
-                            for (int j = 129+2*i; j < 256; j++) {
-                                setBlockAt(x-i, j, z, EMPTY);
-                            }
+                            fillColumn(x-i, z, 129+2*i, 255, EMPTY);
                         }
                     } else {
                         if (h != 256 && h > 128+i) {
                             setBlockAt(x-i, 128+i, z, GRASS);
-                            for (int j = 129+i; j < 256; j++) {
-                                setBlockAt(x-i, j, z, EMPTY);
-                            }
+                            fillColumn(x-i, z, 129+i, 255, EMPTY);
                         }
                     }
                 }
                 int dz = 0;
-                int hzp = 128;
                 while (z+dz < zmax && dz != 6) dz++;
-                while (getBlockAt(x, hzp, z+dz-1) != GRASS && hzp != 256) hzp++;
+                int hzp = grassHeight(x, z+dz-1);
                 for (int i = 1; i < dz-1; i++) {
-                    int h = 128;
-                    while (getBlockAt(x, h, z+i) != GRASS && h != 256) h++;
+                    int h = grassHeight(x, z+i);
                     if (hzp > 135) {
                         if (h != 256 && h > 128+2*i) {
                             setBlockAt(x, 128+2*i, z+i, GRASS);
-                            for (int j = 129+2*i; j < 256; j++) {
-                                setBlockAt(x, j, z+i, EMPTY);
-                            }
+                            fillColumn(x, z+i, 129+2*i, 255, EMPTY);
                         }
                     } else {
                         if (h != 256 && h > 128+i) {
                             setBlockAt(x, 128+i, z+i, GRASS);
-                            for (int j = 129+i; j < 256; j++) {
-                                setBlockAt(x, j, z+i, EMPTY);
-                            }
+                            fillColumn(x, z+i, 129+i, 255, EMPTY);
                         }
                     }
                 }
                 dz = 0;
-                hzp = 128;
                 while (z-dz > zmin && dz != 6) dz++;
-                while (getBlockAt(x, hzp, z-dz+1) != GRASS && hzp != 256) hzp++;
+                hzp = grassHeight(x, z-dz+1);
                 for (int i = 1; i < dz-1; i++) {
-                    int h = 128;
-                    while (getBlockAt(x, h, z-i) != GRASS && h != 256) h++;
+                    int h = grassHeight(x, z-i);
                     if (hzp > 135) {
                         if (h != 256 && h > 128+2*i) {
                             setBlockAt(x, 128+2*i, z-i, GRASS);
-                            for (int j = 129+2*i; j < 256; j++) {
-                                setBlockAt(x, j, z-i, EMPTY);
-                            }
+                            fillColumn(x, z-i, 129+2*i, 255, EMPTY);
                         }
                     } else {
                         if (h != 256 && h > 128+i) {
                             setBlockAt(x, 128+i, z-i, GRASS);
-                            for (int j = 129+i; j < 256; j++) {
-                                setBlockAt(x, j, z-i, EMPTY);
-                            }
+                            fillColumn(x, z-i, 129+i, 255, EMPTY);
                         }
                     }
                 }
@@ -457,35 +701,50 @@ void Terrain::CreateTestScene()
             }
         }
     }
+
+    for(int x = xmin; x < xmax; x += X_BOUND) {
+        for(int z = zmin; z < zmax; z += Z_BOUND) {
+            getChunkAt(x, z)->compactBlocks();
+            getChunkAt(x, z)->publish();
+        }
+    }
 }
 
 void Terrain::terrainUpdate(const glm::vec3 &playerPos){
 
     int x = static_cast<int>(glm::floor(playerPos.x));
+    int y = static_cast<int>(glm::floor(playerPos.y));
     int z = static_cast<int>(glm::floor(playerPos.z));
 
-    for(int i = -2; i < 3; ++i){
-        for(int j = -2; j < 3; ++j){
+    int radius = generationRadius();
+    for(int i = -radius; i <= radius; ++i){
+        for(int j = -radius; j <= radius; ++j){
 
             int xChunk = (static_cast<int>(glm::floor(x / 64.f)) + i) * 64;
             int zChunk = (static_cast<int>(glm::floor(z / 64.f)) + j) * 64;
 
             int64_t key = toKey(xChunk, zChunk);
+            touchZone(key);
+            // Only the 5 x 5 zones that freezeZones leaves alone are
+            // thawed; further ones are drawn from their levels of detail
+            if(glm::abs(i) <= 2 && glm::abs(j) <= 2 &&
+               m_frozenZones.find(key) != m_frozenZones.end()) {
+                thawZone(key);
+            }
             bool hasProcessedChunk =
                     (m_generatedTerrain.find(key) != m_generatedTerrain.end() ||
                      m_generatingTerrain.find(key) != m_generatingTerrain.end());
 
             if(!hasProcessedChunk){
 
-                std::vector<Chunk *> add;
+                std::vector<ChunkData *> add;
 
                 // Link neighbors for all the chunks
                 for(int a = 0; a < 4; ++a){
                     for(int b = 0; b < 4; ++b){
-                        uPtr<Chunk> c = mkU<Chunk>(mp_context,
-                                                   xChunk + X_BOUND*a,
-                                                   zChunk + Z_BOUND*b);
-                        Chunk *cPtr = c.get();
+                        uPtr<ChunkData> c = mkU<ChunkData>(xChunk + X_BOUND*a,
+                                                       zChunk + Z_BOUND*b);
+                        ChunkData *cPtr = c.get();
                         add.push_back(cPtr);
                         m_chunks[toKey(xChunk + a*X_BOUND,
                                        zChunk + b*Z_BOUND)] = move(c);
@@ -493,7 +752,7 @@ void Terrain::terrainUpdate(const glm::vec3 &playerPos){
                         if(hasChunkAt(xChunk + a*X_BOUND,
                                       zChunk + (b+1)*Z_BOUND)){
 
-                            uPtr<Chunk> &zpos = m_chunks[toKey(xChunk + a*X_BOUND,
+                            uPtr<ChunkData> &zpos = m_chunks[toKey(xChunk + a*X_BOUND,
                                                     zChunk + (b+1)*Z_BOUND)];
                             cPtr->linkNeighbor(zpos, Direction::ZPOS);
                         }
@@ -501,7 +760,7 @@ void Terrain::terrainUpdate(const glm::vec3 &playerPos){
                         if(hasChunkAt(xChunk + a*X_BOUND,
                                       zChunk + (b-1)*Z_BOUND)){
 
-                            uPtr<Chunk> &zneg = m_chunks[toKey(xChunk + a*X_BOUND,
+                            uPtr<ChunkData> &zneg = m_chunks[toKey(xChunk + a*X_BOUND,
                                                     zChunk + (b-1)*Z_BOUND)];
                             cPtr->linkNeighbor(zneg, Direction::ZNEG);
                         }
@@ -509,7 +768,7 @@ void Terrain::terrainUpdate(const glm::vec3 &playerPos){
                         if(hasChunkAt(xChunk + (a+1)*X_BOUND,
                                       zChunk + b*Z_BOUND)){
 
-                            uPtr<Chunk> &xpos = m_chunks[toKey(xChunk + (a+1)*X_BOUND,
+                            uPtr<ChunkData> &xpos = m_chunks[toKey(xChunk + (a+1)*X_BOUND,
                                                     zChunk + b*Z_BOUND)];
                             cPtr->linkNeighbor(xpos, Direction::XPOS);
                         }
@@ -517,22 +776,27 @@ void Terrain::terrainUpdate(const glm::vec3 &playerPos){
                         if(hasChunkAt(xChunk + (a-1)*X_BOUND,
                                       zChunk + b*Z_BOUND)){
 
-                            uPtr<Chunk> &xneg = m_chunks[toKey(xChunk + (a-1)*X_BOUND,
+                            uPtr<ChunkData> &xneg = m_chunks[toKey(xChunk + (a-1)*X_BOUND,
                                                     zChunk + b*Z_BOUND)];
                             cPtr->linkNeighbor(xneg, Direction::XNEG);
                         }
                     }
                 }
                 m_generatingTerrain.insert(toKey(xChunk, zChunk));
+                glm::ivec2 window = sectionWindow(y);
+                m_zoneSections[key] = window;
 
                 // call thread to generate terrain
                 getBiome(xChunk, zChunk);
+                m_zoneBiomes[key] = biomesAround(xChunk, zChunk);
                 BlockTypeWorker *thread = new BlockTypeWorker(&chunks,
                                                               &chunkMutex,
                                                               add,
                                                               xChunk,
                                                               zChunk,
-                                                              m_biomeMap);
+                                                              m_zoneBiomes[key],
+                                                              window.x,
+                                                              window.y);
                 QThreadPool::globalInstance()->start(thread);
             }
         }
@@ -546,15 +810,34 @@ void Terrain::terrainUpdate(const glm::vec3 &playerPos){
     chunkMutex.lock();
     while(!chunks.empty()){
 
-        Chunk *cPtr = chunks.front();
+        ChunkData *cPtr = chunks.front();
         VBOWorker *vboWriter = new VBOWorker(&vboMutex,
                                              &chunkData,
-                                             cPtr);
+                                             &m_meshBuffers,
+                                             &m_meshCache,
+                                             cPtr,
+                                             false,
+                                             m_meshMode,
+                                             m_lodSampling);
+        cPtr->clearDirty();
         QThreadPool::globalInstance()->start(vboWriter);
         chunks.erase(chunks.begin());
     }
+    // Each BlockTypeWorker hands back all of its Chunks at once
+    std::unordered_set<int64_t> extended;
+    for(ChunkData *cPtr : extendedChunks) {
+        extended.insert(toKey(static_cast<int>(glm::floor(cPtr->getWorldSpaceX() / 64.f)) * 64,
+                              static_cast<int>(glm::floor(cPtr->getWorldSpaceZ() / 64.f)) * 64));
+    }
+    extendedChunks.clear();
     chunkMutex.unlock();
 
+    for(int64_t key : extended) {
+        installSections(key);
+    }
+    streamSections(x, y, z);
+    dispatchRemeshes();
+
     /*
      * Critical section 2
      * ------------------
@@ -564,19 +847,34 @@ void Terrain::terrainUpdate(const glm::vec3 &playerPos){
     while(!chunkData.empty()){
         uPtr<VBOData> &data = chunkData.front();
 
-        data->cPtr->createCubeVBO(data->posNorCol, data->ix, data->uv,
-                                  data->t_posNorCol, data->t_ix, data->t_uv);
-
+        // Only the levels of detail are rebuilt from a frozen Chunk's
+        // tree. Once the Chunk is thawed, its next mesh brings exact
+        // ones instead.
+        bool fromTree = data->mesh == nullptr;
+        if(!fromTree) {
+            meshOf(data->cPtr)->createCubeVBO(*data->mesh);
+            m_meshBuffers.release(std::move(data->mesh));
+        }
+        for(int level = 1; level <= LOD_LEVELS; ++level) {
+            if(!fromTree || data->cPtr->isFrozen()) {
+                lodMeshOf(data->cPtr, level)->createCubeVBO(*data->lods[level - 1]);
+            }
+            m_meshBuffers.release(std::move(data->lods[level - 1]));
+        }
 
-        data->cPtr->setIndexCount((data->ix).size());
+        if(data->remesh) {
+            m_remeshingChunks.erase(data->cPtr);
+            chunkData.erase(chunkData.begin());
+            continue;
+        }
 
         /*
          * Check if m_generatedTerrain needs to be
          * updated based on m_generatedTerrainBuffer
          */
 
-        int bufX = static_cast<int>(glm::floor(data->cPtr->getWorldSpaceX() / 16.f)) * 16;
-        int bufZ = static_cast<int>(glm::floor(data->cPtr->getWorldSpaceZ() / 16.f)) * 16;//64.f)) * 64;
+        int bufX = static_cast<int>(glm::floor(data->cPtr->getWorldSpaceX() / 64.f)) * 64;
+        int bufZ = static_cast<int>(glm::floor(data->cPtr->getWorldSpaceZ() / 64.f)) * 64;
 
         int64_t bufferKey = toKey(bufX, bufZ);
 
@@ -593,8 +891,503 @@ void Terrain::terrainUpdate(const glm::vec3 &playerPos){
     }
     vboMutex.unlock();
 
+    evictZones(x, z);
+    freezeZones(x, z);
+}
+
+void Terrain::setResidentRadius(int zones) {
+    // Zones that are generated but not resident would be evicted and
+    // generated again on every update
+    m_residentRadius = std::max(zones, generationRadius() + 1);
+}
+
+void Terrain::setPersistenceHook(std::function<void(const ChunkData&)> hook) {
+    m_persistenceHook = hook;
+}
+
+void Terrain::dispatchRemeshes() {
+    for(auto it = m_dirtyChunks.begin(); it != m_dirtyChunks.end();) {
+        ChunkData *cPtr = *it;
+        int64_t zoneKey = toKey(static_cast<int>(glm::floor(cPtr->getWorldSpaceX() / 64.f)) * 64,
+                                static_cast<int>(glm::floor(cPtr->getWorldSpaceZ() / 64.f)) * 64);
+        // Wait for the running remesh, or for the zone's first meshes,
+        // so that an older mesh can never land after a newer one
+        if(m_remeshingChunks.find(cPtr) != m_remeshingChunks.end() ||
+           m_generatingTerrain.find(zoneKey) != m_generatingTerrain.end()) {
+            ++it;
+            continue;
+        }
+        if(cPtr->isDirty()) {
+            // Only the dirty sections are remeshed, and their faces
+            // patched into the Chunk's mesh, so a Chunk without one is
+            // meshed whole
+            if(m_meshes.find(toKey(cPtr->getWorldSpaceX(), cPtr->getWorldSpaceZ())) == m_meshes.end()) {
+                cPtr->markDirty(WORLD_MIN_Y, WORLD_MAX_Y - 1);
+            }
+            VBOWorker *vboWriter = new VBOWorker(&vboMutex,
+                                                 &chunkData,
+                                                 &m_meshBuffers,
+                                                 &m_meshCache,
+                                                 cPtr,
+                                                 true,
+                                                 m_meshMode,
+                                                 m_lodSampling);
+            cPtr->clearDirty();
+            m_remeshingChunks.insert(cPtr);
+            QThreadPool::globalInstance()->start(vboWriter);
+        }
+        it = m_dirtyChunks.erase(it);
+    }
+
+    for(auto it = m_staleLods.begin(); it != m_staleLods.end();) {
+        ChunkData *cPtr = *it;
+        if(m_remeshingChunks.find(cPtr) != m_remeshingChunks.end()) {
+            ++it;
+            continue;
+        }
+        // A Chunk thawed since gets new levels of detail with its mesh
+        auto tree = m_trees.find(toKey(cPtr->getWorldSpaceX(), cPtr->getWorldSpaceZ()));
+        if(cPtr->isFrozen() && tree != m_trees.end()) {
+            VBOWorker *lodWriter = new VBOWorker(&vboMutex,
+                                                 &chunkData,
+                                                 &m_meshBuffers,
+                                                 cPtr,
+                                                 *tree->second,
+                                                 m_lodSampling);
+            m_remeshingChunks.insert(cPtr);
+            QThreadPool::globalInstance()->start(lodWriter);
+        }
+        it = m_staleLods.erase(it);
+    }
 }
 
+void Terrain::setMeshMode(MeshMode mode) {
+    if(mode == m_meshMode) {
+        return;
+    }
+    m_meshMode = mode;
+    // Remesh everything on screen in the background; the old meshes stay
+    // up until the new ones land
+    for(auto &kv : m_meshes) {
+        kv.second->setMode(mode);
+        ChunkData *chunk = m_chunks.at(kv.first).get();
+        chunk->markDirty(WORLD_MIN_Y, WORLD_MAX_Y - 1);
+        m_dirtyChunks.insert(chunk);
+    }
+}
+
+int Terrain::residentZoneCount() const {
+    return m_zoneLRU.size();
+}
+
+ColdTierStats Terrain::coldTierStats() const {
+    return ChunkData::coldTierStats();
+}
+
+void Terrain::setMeshCacheDirectory(const std::string &directory) {
+    m_meshCache.setDirectory(directory);
+}
+
+MeshCacheStats Terrain::meshCacheStats() const {
+    return m_meshCache.stats();
+}
+
+void Terrain::setViewDistance(int chunks) {
+    m_viewDistance = chunks;
+    setResidentRadius(m_residentRadius);
+}
+
+int Terrain::viewDistance() const {
+    return m_viewDistance;
+}
+
+void Terrain::setVerticalRadius(int sections) {
+    m_verticalRadius = std::max(sections, 1);
+}
+
+int Terrain::verticalRadius() const {
+    return m_verticalRadius;
+}
+
+int Terrain::generationRadius() const {
+    // Enough 4-Chunk zones to cover the view distance wherever the
+    // Player stands in their own zone, and never fewer than the 5 x 5
+    // zones kept thawed
+    return std::max(2, (m_viewDistance + 3) / 4);
+}
+
+void Terrain::setLodRings(const std::array<int, LOD_LEVELS> &rings) {
+    m_lodRings = rings;
+}
+
+void Terrain::setLodSampling(LodSampling sampling) {
+    if(sampling == m_lodSampling) {
+        return;
+    }
+    m_lodSampling = sampling;
+    // The old levels of detail stay up until the new ones land
+    for(auto &kv : m_lodMeshes) {
+        ChunkData *chunk = m_chunks.at(kv.first).get();
+        if(chunk->isFrozen()) {
+            m_staleLods.insert(chunk);
+        } else {
+            chunk->markDirty(WORLD_MIN_Y, WORLD_MAX_Y - 1);
+            m_dirtyChunks.insert(chunk);
+        }
+    }
+}
+
+int Terrain::lodLevel(int distance) const {
+    int level = 0;
+    while(level < LOD_LEVELS && distance > m_lodRings[level]) {
+        ++level;
+    }
+    return level;
+}
+
+void Terrain::touchZone(int64_t zoneKey) {
+    auto pos = m_zoneLRUPos.find(zoneKey);
+    if(pos != m_zoneLRUPos.end()) {
+        m_zoneLRU.splice(m_zoneLRU.begin(), m_zoneLRU, pos->second);
+    } else {
+        m_zoneLRU.push_front(zoneKey);
+        m_zoneLRUPos[zoneKey] = m_zoneLRU.begin();
+    }
+}
+
+void Terrain::evictZones(int playerX, int playerZ) {
+    int diameter = 2 * m_residentRadius + 1;
+    size_t capacity = diameter * diameter;
+    glm::ivec2 playerZone(glm::floor(playerX / 64.f), glm::floor(playerZ / 64.f));
+
+    auto it = m_zoneLRU.end();
+    while(m_zoneLRU.size() > capacity && it != m_zoneLRU.begin()) {
+        --it;
+        int64_t key = *it;
+        glm::ivec2 zone = toCoords(key) / 64;
+        bool inRadius = glm::abs(zone.x - playerZone.x) <= m_residentRadius &&
+                        glm::abs(zone.y - playerZone.y) <= m_residentRadius;
+        // Zones still being generated have Chunks in flight on
+        // worker threads, so they have to wait
+        bool generated = m_generatedTerrain.find(key) != m_generatedTerrain.end();
+        if(inRadius || !generated) {
+            continue;
+        }
+        if(evictZone(key)) {
+            m_zoneLRUPos.erase(key);
+            it = m_zoneLRU.erase(it);
+        }
+    }
+}
+
+std::vector<ChunkData*> Terrain::zoneChunks(int64_t zoneKey) {
+    glm::ivec2 origin = toCoords(zoneKey);
+    std::vector<ChunkData*> result;
+    for(int x = origin.x; x < origin.x + 64; x += X_BOUND) {
+        for(int z = origin.y; z < origin.y + 64; z += Z_BOUND) {
+            auto c = m_chunks.find(toKey(x, z));
+            if(c != m_chunks.end()) {
+                result.push_back(c->second.get());
+            }
+        }
+    }
+    return result;
+}
+
+ChunkMesh *Terrain::meshOf(ChunkData *chunk) {
+    uPtr<ChunkMesh> &mesh = m_meshes[toKey(chunk->getWorldSpaceX(), chunk->getWorldSpaceZ())];
+    if(!mesh) {
+        mesh = mkU<ChunkMesh>(mp_context, chunk, m_meshMode);
+    }
+    return mesh.get();
+}
+
+ChunkMesh *Terrain::lodMeshOf(ChunkData *chunk, int level) {
+    uPtr<ChunkMesh> &mesh = m_lodMeshes[toKey(chunk->getWorldSpaceX(), chunk->getWorldSpaceZ())][level - 1];
+    if(!mesh) {
+        mesh = mkU<ChunkMesh>(mp_context, chunk, m_meshMode);
+    }
+    return mesh.get();
+}
+
+ChunkMesh *Terrain::meshAtLevel(const ChunkData *chunk, int level) const {
+    int64_t key = toKey(chunk->getWorldSpaceX(), chunk->getWorldSpaceZ());
+    auto full = m_meshes.find(key);
+    auto lods = m_lodMeshes.find(key);
+    auto meshAt = [&](int l) -> ChunkMesh* {
+        if(l < 0 || l > LOD_LEVELS) {
+            return nullptr;
+        }
+        if(l == 0) {
+            return full == m_meshes.end() ? nullptr : full->second.get();
+        }
+        return lods == m_lodMeshes.end() ? nullptr : lods->second[l - 1].get();
+    };
+    // Only VBOWorkers build meshes, so until the one asked for has
+    // landed the nearest level that has stands in, the coarser first
+    for(int offset = 0; offset <= LOD_LEVELS; ++offset) {
+        ChunkMesh *mesh = meshAt(level + offset);
+        if(mesh == nullptr && offset != 0) {
+            mesh = meshAt(level - offset);
+        }
+        if(mesh != nullptr) {
+            return mesh;
+        }
+    }
+    return nullptr;
+}
+
+void Terrain::dropLodMeshes(const ChunkData *chunk) {
+    auto it = m_lodMeshes.find(toKey(chunk->getWorldSpaceX(), chunk->getWorldSpaceZ()));
+    if(it != m_lodMeshes.end()) {
+        for(uPtr<ChunkMesh> &mesh : it->second) {
+            if(mesh) {
+                mesh->destroy();
+            }
+        }
+        m_lodMeshes.erase(it);
+    }
+}
+
+void Terrain::dropMesh(const ChunkData *chunk) {
+    auto it = m_meshes.find(toKey(chunk->getWorldSpaceX(), chunk->getWorldSpaceZ()));
+    if(it != m_meshes.end()) {
+        it->second->destroy();
+        m_meshes.erase(it);
+    }
+}
+
+bool Terrain::evictZone(int64_t zoneKey) {
+    std::vector<ChunkData*> chunksInZone = zoneChunks(zoneKey);
+    for(ChunkData *chunk : chunksInZone) {
+        if(chunk->isEdited() && !m_persistenceHook) {
+            return false;
+        }
+        if(m_remeshingChunks.find(chunk) != m_remeshingChunks.end()) {
+            return false;
+        }
+    }
+    // BlockTypeWorkers are still writing the zone's new sections
+    if(m_extendingZones.find(zoneKey) != m_extendingZones.end()) {
+        return false;
+    }
+
+    for(ChunkData *chunk : chunksInZone) {
+        m_dirtyChunks.erase(chunk);
+        m_staleLods.erase(chunk);
+        if(chunk->isEdited()) {
+            m_persistenceHook(*chunk);
+        }
+        chunk->unlinkNeighbors();
+        dropMesh(chunk);
+        dropLodMeshes(chunk);
+        int64_t key = toKey(chunk->getWorldSpaceX(), chunk->getWorldSpaceZ());
+        m_trees.erase(key);
+        m_chunks.erase(key);
+    }
+    m_generatedTerrain.erase(zoneKey);
+    m_generatingTerrain.erase(zoneKey);
+    m_generatedTerrainBuffer.erase(zoneKey);
+    m_frozenZones.erase(zoneKey);
+    m_zoneSections.erase(zoneKey);
+    m_zoneBiomes.erase(zoneKey);
+    return true;
+}
+
+void Terrain::freezeZones(int playerX, int playerZ) {
+    // Don't drop meshes that VBOWorkers are about to upload
+    if(!m_generatingTerrain.empty() || !m_remeshingChunks.empty()) {
+        return;
+    }
+    glm::ivec2 playerZone(glm::floor(playerX / 64.f), glm::floor(playerZ / 64.f));
+
+    for(int64_t key : m_zoneLRU) {
+        glm::ivec2 zone = toCoords(key) / 64;
+        if(glm::abs(zone.x - playerZone.x) <= 2 && glm::abs(zone.y - playerZone.y) <= 2) {
+            continue;
+        }
+        if(m_generatedTerrain.find(key) == m_generatedTerrain.end() ||
+           m_extendingZones.find(key) != m_extendingZones.end()) {
+            continue;
+        }
+        // Zones that are already frozen are revisited too, since meshing
+        // the Chunks next to them thaws their border Chunks
+        for(ChunkData *chunk : zoneChunks(key)) {
+            if(!chunk->isFrozen()) {
+                // Its levels of detail have to catch up with its blocks
+                // first, and a later update freezes it
+                if(m_dirtyChunks.find(chunk) != m_dirtyChunks.end()) {
+                    continue;
+                }
+                dropMesh(chunk);
+                uPtr<ChunkTree> &tree = m_trees[toKey(chunk->getWorldSpaceX(), chunk->getWorldSpaceZ())];
+                if(!tree) {
+                    tree = mkU<ChunkTree>(*chunk->snapshot());
+                }
+                chunk->freeze();
+            } else {
+                // Thawing the zone remeshes all of it anyway
+                m_dirtyChunks.erase(chunk);
+            }
+            // Far zones are only ever drawn from their levels of detail
+            if(m_lodMeshes.find(toKey(chunk->getWorldSpaceX(), chunk->getWorldSpaceZ())) == m_lodMeshes.end()) {
+                m_staleLods.insert(chunk);
+            }
+        }
+        m_frozenZones.insert(key);
+    }
+}
+
+void Terrain::thawZone(int64_t zoneKey) {
+    m_frozenZones.erase(zoneKey);
+    std::vector<ChunkData*> chunksInZone = zoneChunks(zoneKey);
+    for(ChunkData *chunk : chunksInZone) {
+        chunk->thaw();
+        m_trees.erase(toKey(chunk->getWorldSpaceX(), chunk->getWorldSpaceZ()));
+    }
+
+    // The zone goes back through the same VBO pipeline as a freshly
+    // generated one, and counts as generated again once it is done
+    m_generatedTerrain.erase(zoneKey);
+    m_generatingTerrain.insert(zoneKey);
+    m_generatedTerrainBuffer[zoneKey] = 0;
+
+    chunkMutex.lock();
+    chunks.insert(chunks.end(), chunksInZone.begin(), chunksInZone.end());
+    chunkMutex.unlock();
+}
+
+// Sections the window has to move past a zone's generated ones before
+// they are dropped, so that walking up and down a slope doesn't
+// generate the same sections over and over
+static const int SECTION_HYSTERESIS = 2;
+
+glm::ivec2 Terrain::sectionWindow(int y) const {
+    int s = sectionOf(glm::clamp(y, WORLD_MIN_Y, WORLD_MAX_Y - 1));
+    return glm::ivec2(std::max(s - m_verticalRadius, 0),
+                      std::min(s + m_verticalRadius, SECTION_COUNT - 1));
+}
+
+void Terrain::streamSections(int playerX, int playerY, int playerZ) {
+    glm::ivec2 window = sectionWindow(playerY);
+    glm::ivec2 keep(window.x - SECTION_HYSTERESIS, window.y + SECTION_HYSTERESIS);
+    glm::ivec2 playerZone(glm::floor(playerX / 64.f), glm::floor(playerZ / 64.f));
+
+    // The same 5 x 5 zones that freezeZones leaves thawed. Zones still
+    // being generated, or thawed, catch up once they are done.
+    for(int i = -2; i <= 2; ++i) {
+        for(int j = -2; j <= 2; ++j) {
+            int64_t key = toKey((playerZone.x + i) * 64, (playerZone.y + j) * 64);
+            auto generated = m_zoneSections.find(key);
+            if(generated == m_zoneSections.end() ||
+               m_generatedTerrain.find(key) == m_generatedTerrain.end() ||
+               m_frozenZones.find(key) != m_frozenZones.end() ||
+               m_extendingZones.find(key) != m_extendingZones.end()) {
+                continue;
+            }
+            // CreateTestScene builds its zone by hand, so there are no
+            // biomes to generate more of it from, and what it drops
+            // could never be generated back
+            if(m_zoneBiomes.find(key) == m_zoneBiomes.end()) {
+                continue;
+            }
+            glm::ivec2 &sections = generated->second;
+
+            // One end at a time, so that the generated sections stay
+            // a single range
+            if(window.x < sections.x) {
+                extendZone(key, glm::ivec2(window.x, sections.x - 1));
+                continue;
+            }
+            if(window.y > sections.y) {
+                extendZone(key, glm::ivec2(sections.y + 1, window.y));
+                continue;
+            }
+            if(sections.x >= keep.x && sections.y <= keep.y) {
+                continue;
+            }
+
+            // Blocks the Player changed are never dropped
+            std::vector<ChunkData*> chunksInZone = zoneChunks(key);
+            if(std::any_of(chunksInZone.begin(), chunksInZone.end(),
+                           [](const ChunkData *chunk) { return chunk->isEdited(); })) {
+                continue;
+            }
+            for(ChunkData *chunk : chunksInZone) {
+                if(sections.x < keep.x) {
+                    chunk->clearSections(sections.x, keep.x - 1);
+                    queueRemesh(chunk, sectionFloor(sections.x), sectionFloor(keep.x) - 1);
+                }
+                if(sections.y > keep.y) {
+                    chunk->clearSections(keep.y + 1, sections.y);
+                    queueRemesh(chunk, sectionFloor(keep.y + 1), sectionFloor(sections.y + 1) - 1);
+                }
+                chunk->publish();
+            }
+            sections = glm::ivec2(std::max(sections.x, keep.x), std::min(sections.y, keep.y));
+        }
+    }
+}
+
+void Terrain::extendZone(int64_t zoneKey, glm::ivec2 sections) {
+    std::vector<ChunkData*> chunksInZone = zoneChunks(zoneKey);
+    if(chunksInZone.empty()) {
+        return;
+    }
+    // The new sections are generated into Chunks of their own, since
+    // the zone's Chunks may only be written by the game thread
+    ZoneExtension &extension = m_extendingZones[zoneKey];
+    extension.sections = sections;
+    std::vector<ChunkData*> add;
+    for(ChunkData *chunk : chunksInZone) {
+        extension.chunks.push_back(mkU<ChunkData>(chunk->getWorldSpaceX(), chunk->getWorldSpaceZ()));
+        add.push_back(extension.chunks.back().get());
+    }
+
+    glm::ivec2 origin = toCoords(zoneKey);
+    BlockTypeWorker *thread = new BlockTypeWorker(&extendedChunks,
+                                                  &chunkMutex,
+                                                  add,
+                                                  origin.x,
+                                                  origin.y,
+                                                  m_zoneBiomes.at(zoneKey),
+                                                  sections.x,
+                                                  sections.y);
+    QThreadPool::globalInstance()->start(thread);
+}
+
+void Terrain::installSections(int64_t zoneKey) {
+    auto extension = m_extendingZones.find(zoneKey);
+    glm::ivec2 sections = extension->second.sections;
+    for(uPtr<ChunkData> &generated : extension->second.chunks) {
+        ChunkData *chunk = findChunk(generated->getWorldSpaceX(), generated->getWorldSpaceZ());
+        chunk->adoptSections(*generated, sections.x, sections.y);
+        chunk->publish();
+        queueRemesh(chunk, sectionFloor(sections.x), sectionFloor(sections.y + 1) - 1);
+    }
+
+    glm::ivec2 &generated = m_zoneSections[zoneKey];
+    generated = glm::ivec2(std::min(generated.x, sections.x), std::max(generated.y, sections.y));
+    m_extendingZones.erase(extension);
+}
+
+void Terrain::queueRemesh(ChunkData *chunk, int yMin, int yMax) {
+    chunk->markDirty(yMin, yMax);
+    m_dirtyChunks.insert(chunk);
+
+    const std::array<glm::ivec2, 4> offsets {
+        glm::ivec2(1, 0), glm::ivec2(-1, 0), glm::ivec2(0, 1), glm::ivec2(0, -1)
+    };
+    for(const glm::ivec2 &offset : offsets) {
+        ChunkData *neighbor = findChunk(chunk->getWorldSpaceX() + offset.x * X_BOUND,
+                                        chunk->getWorldSpaceZ() + offset.y * Z_BOUND);
+        // Frozen Chunks have no full mesh to fix
+        if(neighbor != nullptr && !neighbor->isFrozen()) {
+            neighbor->markDirty(yMin, yMax);
+            m_dirtyChunks.insert(neighbor);
+        }
+    }
+}
 
 void Terrain::drawRiver(int xmin, int xmax, int zmin, int zmax) {
     River* river = new River();
@@ -619,11 +1412,9 @@ void Terrain::drawRiver(int xmin, int xmax, int zmin, int zmax) {
                             setBlockAt(x1+i*dx+j, 128, z1+i*dz, WATER);
                             setBlockAt(x1+i*dx, 128, z1+i*dz+j, WATER);
                             setBlockAt(x1+i*dx+j, 128, z1+i*dz+j, WATER);
-                            for(int y = 129; y < 256; y++) {
-                                setBlockAt(x1+i*dx+j, y, z1+i*dz, EMPTY);
-                                setBlockAt(x1+i*dx, y, z1+i*dz+j, EMPTY);
-                                setBlockAt(x1+i*dx+j, y, z1+i*dz+j, EMPTY);
-                            }
+                            fillColumn(x1+i*dx+j, z1+i*dz, 129, 255, EMPTY);
+                            fillColumn(x1+i*dx, z1+i*dz+j, 129, 255, EMPTY);
+                            fillColumn(x1+i*dx+j, z1+i*dz+j, 129, 255, EMPTY);
                         }
                     }
                 }
@@ -701,4 +1492,15 @@ std::pair<glm::vec2, Biomes> Terrain::getBiome(int x, int z){
     return value;
 }
 
-
+std::unordered_map<int64_t, std::pair<glm::vec2, Biomes>> Terrain::biomesAround(int x, int z) const {
+    std::unordered_map<int64_t, std::pair<glm::vec2, Biomes>> biomes;
+    for(int cx = x - X_BOUND; cx <= x + 64; cx += X_BOUND) {
+        for(int cz = z - Z_BOUND; cz <= z + 64; cz += Z_BOUND) {
+            auto biome = m_biomeMap.find(toKey(cx, cz));
+            if(biome != m_biomeMap.end()) {
+                biomes.insert(*biome);
+            }
+        }
+    }
+    return biomes;
+}
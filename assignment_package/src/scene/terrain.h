@@ -1,6 +1,8 @@
 #pragma once
 
 #include <array>
+#include <functional>
+#include <list>
 #include <unordered_map>
 #include <unordered_set>
 #include <QThreadPool>
@@ -10,7 +12,8 @@
 #include "vboworker.h"
 #include "smartpointerhelp.h"
 #include "glm_includes.h"
-#include "chunk.h"
+#include "chunkmesh.h"
+#include "chunktree.h"
 #include "blocktypeworker.h"
 #include "vboworker.h"
 #include "river.h"
@@ -33,9 +36,17 @@ private:
     // We combine the X and Z coordinates of the Chunk's corner into one 64-bit int
     // so that we can use them as a key for the map, as objects like std::pairs or
     // glm::ivec2s are not hashable by default, so they cannot be used as keys.
-    std::unordered_map<int64_t, uPtr<Chunk>> m_chunks;
+    std::unordered_map<int64_t, uPtr<ChunkData>> m_chunks;
+    // The GPU meshes of the Chunks that currently have one, under the
+    // same keys as m_chunks. Frozen and evicted Chunks have none.
+    std::unordered_map<int64_t, uPtr<ChunkMesh>> m_meshes;
 
     std::unordered_map<int64_t, std::pair<glm::vec2, Biomes>> m_biomeMap;
+    // The part of m_biomeMap each zone was generated from: the biomes of
+    // its Chunks and of the Chunks around them. getBiome keeps changing
+    // m_biomeMap, so sections generated for the zone later on read these
+    // to match the rest of it.
+    std::unordered_map<int64_t, std::unordered_map<int64_t, std::pair<glm::vec2, Biomes>>> m_zoneBiomes;
 
     // We will designate every 64 x 64 area of the world's x-z plane
     // as one "terrain generation zone". Every time the player moves
@@ -48,8 +59,10 @@ private:
     // When milestone 1 has been implemented, the Player can move around the
     // world to add more "terrain generation zone" IDs to this set.
     // While only the 3 x 3 collection of terrain generation zones
-    // surrounding the Player should be rendered, the Chunks
-    // in the Terrain will never be deleted until the program is terminated.
+    // surrounding the Player should be rendered, Chunks stay resident
+    // as long as their zone lies within m_residentRadius zones of the
+    // Player. Beyond that, zones are evicted least recently used first
+    // (see evictZones).
     std::unordered_set<int64_t> m_generatedTerrain;
 
     std::unordered_set<int64_t> m_generatingTerrain;
@@ -57,13 +70,167 @@ private:
 
     OpenGLContext* mp_context;
 
+    // Chunk unloading
+    // Resident zones ordered from most to least recently near the
+    // Player, plus each zone's position in that list
+    std::list<int64_t> m_zoneLRU;
+    std::unordered_map<int64_t, std::list<int64_t>::iterator> m_zoneLRUPos;
+    // How many zones around the Player (in each direction) are kept
+    // resident no matter how long ago they were visited
+    int m_residentRadius;
+    // Receives Chunks the player edited right before they are evicted.
+    // Without a hook, edited Chunks are never evicted.
+    std::function<void(const ChunkData&)> m_persistenceHook;
+
+    // Marks the zone with the given key as just visited
+    void touchZone(int64_t zoneKey);
+    // Unloads least recently used zones outside the resident radius
+    // until no more than (2 * radius + 1)^2 zones remain
+    void evictZones(int playerX, int playerZ);
+    // Returns false (and keeps the zone) if one of its Chunks was edited
+    // and there is no persistence hook to hand it to
+    bool evictZone(int64_t zoneKey);
+
+    // Compressed cold tier
+    // Resident zones outside the 5 x 5 zones around the Player whose
+    // Chunks have been frozen (see ChunkData::freeze) and had their VBOs
+    // dropped. Walking back into one thaws it and remeshes its Chunks.
+    std::unordered_set<int64_t> m_frozenZones;
+
+    // Freezes every Chunk of each generated zone outside the window
+    // around the Player
+    void freezeZones(int playerX, int playerZ);
+    // Thaws a frozen zone and queues its Chunks for new VBOs
+    void thawZone(int64_t zoneKey);
+
+    // A 64-tree of each frozen Chunk's blocks, built as the Chunk is
+    // frozen, under the same keys as m_chunks. Occupancy and ray queries
+    // on far Chunks read these, so the Chunks stay compressed. Dropped
+    // when the Chunk's blocks change or its zone is thawed.
+    std::unordered_map<int64_t, uPtr<ChunkTree>> m_trees;
+    // The Chunks of the zone with the given key that exist
+    std::vector<ChunkData*> zoneChunks(int64_t zoneKey);
+
+    // Remeshing after edits
+    // Chunks whose mesh is out of date, and Chunks with a remesh
+    // VBOWorker still running. A Chunk only ever has one remesh in
+    // flight; edits made meanwhile are picked up once it lands. The old
+    // mesh stays on screen until the new one is uploaded.
+    std::unordered_set<ChunkData*> m_dirtyChunks;
+    std::unordered_set<ChunkData*> m_remeshingChunks;
+    // Frozen Chunks whose levels of detail are missing or out of date.
+    // These are rebuilt from their trees, so the Chunks stay frozen.
+    std::unordered_set<ChunkData*> m_staleLods;
+
+    // Starts a VBOWorker for every dirty Chunk, and every Chunk with
+    // stale levels of detail, that is ready for one
+    void dispatchRemeshes();
+
+    // The mesh of the given Chunk, created empty if it has none yet
+    ChunkMesh *meshOf(ChunkData *chunk);
+    // Frees the given Chunk's VBOs and forgets its mesh
+    void dropMesh(const ChunkData *chunk);
+    // How new meshes are built
+    MeshMode m_meshMode;
+    // The index buffer every ChunkMesh is drawn with, created on the
+    // first draw
+    QuadIndices m_quadIndices;
+
+    // Levels of detail
+    // The coarser meshes of every Chunk that has them, level l at index
+    // l - 1, under the same keys as m_chunks. Unlike the full meshes
+    // these are kept while a Chunk is frozen, which is what lets far
+    // zones be drawn without thawing them.
+    std::unordered_map<int64_t, std::array<uPtr<ChunkMesh>, LOD_LEVELS>> m_lodMeshes;
+    // Chunks up to m_lodRings[0] Chunks from the middle of the drawn
+    // area (in either x or z) get their full mesh, those up to
+    // m_lodRings[l] get level l + 1, and the rest the coarsest level
+    std::array<int, LOD_LEVELS> m_lodRings;
+    LodSampling m_lodSampling;
+    // How many Chunks around the Player's own are generated and drawn.
+    // 2 by default, which keeps every Chunk drawn at full detail.
+    int m_viewDistance;
+
+    // The level of detail of a Chunk the given number of Chunks from
+    // the middle of the drawn area
+    int lodLevel(int distance) const;
+    // The given level of detail of a Chunk, created empty if it has none
+    ChunkMesh *lodMeshOf(ChunkData *chunk, int level);
+    // The mesh to draw the given Chunk with at the given level, or the
+    // nearest level it has if that one hasn't been built yet. Null if
+    // it has no mesh at all. Never meshes anything itself; frozen Chunks
+    // have only their levels of detail.
+    ChunkMesh *meshAtLevel(const ChunkData *chunk, int level) const;
+    // Frees the given Chunk's levels of detail
+    void dropLodMeshes(const ChunkData *chunk);
+    // Zones around the Player's own that terrainUpdate generates
+    int generationRadius() const;
+
+    // Vertical streaming
+    // Chunks only hold the sections within m_verticalRadius sections of
+    // the Player's, plus whatever the Player built outside them. Each
+    // generated zone's Chunks hold the sections in its m_zoneSections
+    // range (inclusive); the zones kept thawed are extended up or down
+    // as the Player moves, and dropped again once they are well outside
+    // the window (see streamSections). The test scene's zone, which was
+    // never generated, keeps the sections it was built with.
+    int m_verticalRadius;
+    std::unordered_map<int64_t, glm::ivec2> m_zoneSections;
+    // A zone whose window is being extended: the sections being
+    // generated, and the Chunks they are generated into. Those are
+    // handed back through extendedChunks, and their sections copied
+    // into the zone's own Chunks by installSections.
+    struct ZoneExtension {
+        glm::ivec2 sections;
+        std::vector<uPtr<ChunkData>> chunks;
+    };
+    std::unordered_map<int64_t, ZoneExtension> m_extendingZones;
+    std::vector<ChunkData*> extendedChunks;
+
+    // The sections within the vertical window around height y
+    glm::ivec2 sectionWindow(int y) const;
+    // Starts generating the sections the window has moved onto in the
+    // zones around the Player, and drops those it has left behind
+    void streamSections(int playerX, int playerY, int playerZ);
+    // Generates the given sections of a zone on a BlockTypeWorker
+    void extendZone(int64_t zoneKey, glm::ivec2 sections);
+    // Hands the zone's finished extension over to its Chunks
+    void installSections(int64_t zoneKey);
+    // Queues the given blocks of a Chunk, and of the neighbours whose
+    // faces touch them, to be remeshed
+    void queueRemesh(ChunkData *chunk, int yMin, int yMax);
+
     // Milestone 2 : Multithreading
-    std::vector<Chunk*> chunks;
+    std::vector<ChunkData*> chunks;
     std::vector<uPtr<VBOData>> chunkData;
+    // Buffers for VBOWorkers to mesh into, recycled after each upload
+    MeshBufferPool m_meshBuffers;
+    // Meshes VBOWorkers have built, by the content they were built from
+    MeshCache m_meshCache;
     QMutex chunkMutex;
     QMutex vboMutex;
 
     Biomes randomBiomeType();
+    // The biomes of the zone with its lower-left corner at x, z and of
+    // the Chunks around it (see m_zoneBiomes)
+    std::unordered_map<int64_t, std::pair<glm::vec2, Biomes>> biomesAround(int x, int z) const;
+
+    // Height of the grass block capping the column at x, z, or 256 if
+    // the column's top block is not grass. Used by CreateTestScene to
+    // shape the river banks.
+    int grassHeight(int x, int z) const;
+
+    // The Chunk containing world-space x, z, or null if there is none.
+    // Costs a single hash lookup.
+    const ChunkData *findChunk(int x, int z) const;
+    ChunkData *findChunk(int x, int z);
+    // The tree of the Chunk containing world-space x, z, or null if that
+    // Chunk has none
+    const ChunkTree *findTree(int x, int z) const;
+    // Side length (16, 4 or 1) of the largest aligned cube around the
+    // given block that is known to be empty, or 0 if the block itself
+    // is not EMPTY
+    int emptyCubeSize(glm::ivec3 p) const;
 
 public:
     Terrain(OpenGLContext *context);
@@ -72,36 +239,80 @@ public:
     // Instantiates a new Chunk and stores it in
     // our chunk map at the given coordinates.
     // Returns a pointer to the created Chunk.
-    Chunk* instantiateChunkAt(int x, int z);
+    ChunkData* instantiateChunkAt(int x, int z);
     // Do these world-space coordinates lie within
     // a Chunk that exists?
     bool hasChunkAt(int x, int z) const;
     // Assuming a Chunk exists at these coords,
     // return a mutable reference to it
-    uPtr<Chunk>& getChunkAt(int x, int z);
+    uPtr<ChunkData>& getChunkAt(int x, int z);
     // Assuming a Chunk exists at these coords,
     // return a const reference to it
-    const uPtr<Chunk>& getChunkAt(int x, int z) const;
+    const uPtr<ChunkData>& getChunkAt(int x, int z) const;
     // Given a world-space coordinate (which may have negative
     // values) return the block stored at that point in space.
     BlockType getBlockAt(int x, int y, int z) const;
     BlockType getBlockAt(glm::vec3 p) const;
+    // Given a world-space x and z, return the y of the highest
+    // non-empty block in that column (or NO_SURFACE if the column is empty),
+    // and the type of that block. Both are O(1) lookups into the
+    // Chunk's heightmap.
+    int getSurfaceHeight(int x, int z) const;
+    BlockType getSurfaceBlock(int x, int z) const;
+    // Occupancy queries answered from the Chunks' bit masks. Unlike
+    // getBlockAt these never throw: anything outside the existing
+    // Chunks counts as empty.
+    bool isOpaqueAt(int x, int y, int z) const;
+    bool isOccupiedAt(int x, int y, int z) const;
+    // Has the block at x, y, z been generated? Blocks outside the
+    // sections generated for their zone have not, even in a Chunk that
+    // exists.
+    bool isGeneratedAt(int x, int y, int z) const;
+    // How the block at x, y, z stops things moving into it (see BlockInfo)
+    Collision collisionAt(int x, int y, int z) const;
+    // Is any block in the inclusive world-space box from min to max not EMPTY?
+    bool anyOccupiedInBox(glm::ivec3 min, glm::ivec3 max) const;
+    // Finds the first block that is not EMPTY along the ray, within
+    // maxDist of its origin, not counting the block the origin is in.
+    // It skips empty sections and bricks whole, and reads far Chunks
+    // from their trees. outNormal, if given, receives the normal of the
+    // face the ray entered the block through.
+    bool raycast(glm::vec3 origin, glm::vec3 direction, float maxDist,
+                 float *outDist, glm::ivec3 *outBlockHit,
+                 glm::ivec3 *outNormal = nullptr) const;
     // Given a world-space coordinate (which may have negative
     // values) set the block at that point in space to the
     // given type.
     void setBlockAt(int x, int y, int z, BlockType t);
+    // Sets a block on behalf of the Player. Unlike setBlockAt this
+    // publishes the change and queues the Chunk, and any neighbour
+    // whose faces touch the block, to be remeshed in the background.
+    void editBlockAt(int x, int y, int z, BlockType t);
+    // World-space counterparts of the Chunks' bulk accessors (see
+    // ChunkData::fillBox). These split the given range across every
+    // Chunk it overlaps; blocks in Chunks that don't exist are read as
+    // EMPTY and left unwritten. All bounds are inclusive.
+    void fillColumn(int x, int z, int yMin, int yMax, BlockType t);
+    void fillBox(glm::ivec3 min, glm::ivec3 max, BlockType t);
+    void readSpan(int x, int z, int yMin, int yMax, BlockType *out) const;
+    // Copies the box from srcMin to srcMax so that srcMin lands on
+    // dstMin. The boxes may overlap.
+    void copyRegion(glm::ivec3 srcMin, glm::ivec3 srcMax, glm::ivec3 dstMin);
 
     // Draws every Chunk that falls within the bounding box
     // described by the min and max coords, using the provided
-    // ShaderProgram
-    void draw(int minX, int maxX, int minZ, int maxZ, ShaderProgram *shaderProgram);
+    // ShaderProgram. Only the sections between minY and maxY are drawn.
+    // Chunks further from the middle of the box are drawn with coarser
+    // meshes (see setLodRings).
+    void draw(int minX, int maxX, int minY, int maxY, int minZ, int maxZ,
+              ShaderProgram *shaderProgram);
 
     // Initializes the Chunks that store the 64 x 256 x 64 block scene you
     // see when the base code is run.
     void CreateTestScene();
 
     // Milestone 2 : Multithreading
-    Chunk *generateChunk(int x, int z);
+    ChunkData *generateChunk(int x, int z);
 
     std::pair<glm::vec2, Biomes> getBiome(int, int);
 
@@ -111,5 +322,35 @@ public:
      */
     void terrainUpdate(const glm::vec3 &playerPos);
 
+    // Radius, in 64 x 64 terrain generation zones, around the Player
+    // within which Chunks are never unloaded. Never less than one zone
+    // beyond the generation radius.
+    void setResidentRadius(int zones);
+    void setPersistenceHook(std::function<void(const ChunkData&)> hook);
+    // Switches every Chunk between one quad per face and merged faces
+    void setMeshMode(MeshMode mode);
+    int residentZoneCount() const;
+    ColdTierStats coldTierStats() const;
+    // Keeps meshes of generated Chunks in the given directory between
+    // sessions, or only in memory if it is empty. Up to 256 MB of them
+    // are kept there, the least recently used deleted first.
+    void setMeshCacheDirectory(const std::string &directory);
+    MeshCacheStats meshCacheStats() const;
+    // Chunks around the Player's own that are generated and drawn. Also
+    // widens the resident radius if it no longer covers them.
+    void setViewDistance(int chunks);
+    int viewDistance() const;
+    // Sections above and below the Player's own that are generated and
+    // drawn. Defaults to 8, which covers the whole generated band from
+    // the surface.
+    void setVerticalRadius(int sections);
+    int verticalRadius() const;
+    // Distances, in Chunks, out to which the full mesh and each level of
+    // detail but the coarsest are drawn. Defaults to 2, 4 and 8.
+    void setLodRings(const std::array<int, LOD_LEVELS> &rings);
+    // Rebuilds every level of detail in the background, those of
+    // frozen Chunks from their trees
+    void setLodSampling(LodSampling sampling);
+
     void drawRiver(int, int, int, int);
 };
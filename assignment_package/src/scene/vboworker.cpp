@@ -1,38 +1,131 @@
 #include "vboworker.h"
 
-VBOData::VBOData(Chunk *cPtr) :
-    ix(std::vector<GLuint>()),
-    posNorCol(std::vector<glm::vec4>()),
-    uv(),
-    t_ix(std::vector<GLuint>()),
-    t_posNorCol(std::vector<glm::vec4>()),
-    t_uv(),
-    cPtr(cPtr) { }
+MeshBufferPool::MeshBufferPool(size_t maxBuffers, size_t maxBytes) :
+    m_free(), m_mutex(), m_maxBuffers(maxBuffers), m_maxBytes(maxBytes) { }
+
+uPtr<MeshBuffers> MeshBufferPool::acquire() {
+    uPtr<MeshBuffers> buffers;
+    {
+        QMutexLocker locker(&m_mutex);
+        if(!m_free.empty()) {
+            buffers = std::move(m_free.back());
+            m_free.pop_back();
+        }
+    }
+    return buffers ? std::move(buffers) : mkU<MeshBuffers>();
+}
+
+void MeshBufferPool::release(uPtr<MeshBuffers> buffers) {
+    if(!buffers || buffers->capacityBytes() > m_maxBytes) {
+        return;
+    }
+    buffers->clear();
+    QMutexLocker locker(&m_mutex);
+    if(m_free.size() < m_maxBuffers) {
+        m_free.push_back(std::move(buffers));
+    }
+}
+
+VBOData::VBOData(ChunkData *cPtr, bool remesh, uPtr<MeshBuffers> mesh) :
+    mesh(std::move(mesh)),
+    cPtr(cPtr),
+    remesh(remesh) { }
 
 
 VBOWorker::VBOWorker(QMutex *mutex,
                      std::vector<uPtr<VBOData>> *vboData,
-                     Chunk *cPtr) :
+                     MeshBufferPool *pool,
+                     MeshCache *cache,
+                     ChunkData *cPtr,
+                     bool remesh,
+                     MeshMode mode,
+                     LodSampling lodSampling) :
     mutex(mutex),
     vboData(vboData),
-    vbo(mkU<VBOData>(cPtr)),
-    cPtr(cPtr) { }
+    cache(cache),
+    vbo(mkU<VBOData>(cPtr, remesh, pool->acquire())),
+    cPtr(cPtr),
+    input(cPtr->meshInput()),
+    sections(remesh ? cPtr->dirtySections() : std::bitset<SECTION_COUNT>().set()),
+    mode(mode),
+    lodSampling(lodSampling),
+    tree()
+{
+    for(uPtr<MeshBuffers> &lod : vbo->lods) {
+        lod = pool->acquire();
+    }
+}
+
+VBOWorker::VBOWorker(QMutex *mutex,
+                     std::vector<uPtr<VBOData>> *vboData,
+                     MeshBufferPool *pool,
+                     ChunkData *cPtr,
+                     const ChunkTree &tree,
+                     LodSampling lodSampling) :
+    mutex(mutex),
+    vboData(vboData),
+    cache(nullptr),
+    vbo(mkU<VBOData>(cPtr, true, nullptr)),
+    cPtr(cPtr),
+    input(),
+    sections(),
+    mode(GREEDY),
+    lodSampling(lodSampling),
+    // Terrain drops its tree when the Chunk is thawed or evicted
+    tree(mkU<ChunkTree>(tree))
+{
+    for(uPtr<MeshBuffers> &lod : vbo->lods) {
+        lod = pool->acquire();
+    }
+}
 
 void VBOWorker::run(){
-    /*
-     * Create chunks and set
-     * num_vertices in chunk to ix.size()
-     */
-
-    vbo->cPtr->createChunk( &(vbo->posNorCol),
-                            &(vbo->ix),
-                            &(vbo->uv),
-                            &(vbo->t_posNorCol),
-                            &(vbo->t_ix),
-                            &(vbo->t_uv));
+    if(tree) {
+        for(int level = 1; level <= LOD_LEVELS; ++level) {
+            ChunkMesh::createLodChunk(*tree, level, lodSampling, vbo->lods[level - 1].get());
+        }
+    } else {
+        meshChunk();
+    }
 
     // Critical section
-    mutex->lock();
+    QMutexLocker locker(mutex);
     vboData->push_back(std::move(vbo));
-    mutex->unlock();
+}
+
+void VBOWorker::meshChunk() {
+    // Mesh straight into the buffers that will be uploaded; only the
+    // VBOData's pointer changes hands from here on. The cache only holds
+    // whole Chunks, and the levels of detail go under keys derived from
+    // their Chunk's.
+    bool cached = cache != nullptr && sections.all();
+    uint64_t key = cached ? MeshCache::keyOf(input, mode) : 0;
+    // Edited Chunks rarely come back to the exact same blocks, so only
+    // meshes of whole generated Chunks are worth keeping across sessions
+    bool persist = !vbo->remesh;
+
+    if(!sections.all()) {
+        // After an edit only the sections it touched are meshed, which
+        // is what keeps edits quick to show
+        ChunkMesh::createChunk(input, vbo->mesh.get(), mode, &sections);
+    } else if(!cached || !cache->lookup(key, vbo->mesh.get())) {
+        ChunkMesh::createChunk(input, vbo->mesh.get(), mode);
+        if(cached) {
+            cache->store(key, *vbo->mesh, persist);
+        }
+    }
+    // The levels of detail only read the Chunk itself, and are cheap
+    // enough to build alongside every mesh, so that a Chunk is ready to
+    // be drawn from afar as soon as the Player walks away from it. Terrain
+    // never builds them itself.
+    for(int level = 1; level <= LOD_LEVELS; ++level) {
+        MeshBuffers *lod = vbo->lods[level - 1].get();
+        uint64_t lodKey = cached ? MeshCache::lodKeyOf(key, level, lodSampling) : 0;
+        if(!cached || !cache->lookup(lodKey, lod)) {
+            ChunkMesh::createLodChunk(*input.center, level, lodSampling, lod);
+            if(cached) {
+                cache->store(lodKey, *lod, persist);
+            }
+        }
+    }
 }
@@ -2,20 +2,43 @@
 #define VBOWORKER_H
 
 #include <QRunnable>
-#include "chunk.h"
+#include "chunkmesh.h"
+#include "chunktree.h"
+#include "meshcache.h"
 #include <QMutex>
 
+// MeshBuffers that have been uploaded, kept for the next VBOWorker so
+// that meshing reuses their memory rather than growing new vectors
+// every time. Buffers that grew unusually large are freed rather than
+// kept, and so are any beyond the pool's limit.
+class MeshBufferPool {
+private:
+    std::vector<uPtr<MeshBuffers>> m_free;
+    QMutex m_mutex;
+    size_t m_maxBuffers;
+    size_t m_maxBytes;
+
+public:
+    MeshBufferPool(size_t maxBuffers = 32, size_t maxBytes = 16 << 20);
+
+    // A cleared MeshBuffers, recycled if there is one
+    uPtr<MeshBuffers> acquire();
+    void release(uPtr<MeshBuffers> buffers);
+};
+
 class VBOData {
 public:
-    std::vector<GLuint> ix;
-    std::vector<glm::vec4> posNorCol;
-    std::vector<glm::vec2> uv;
-    std::vector<GLuint> t_ix;
-    std::vector<glm::vec4> t_posNorCol;
-    std::vector<glm::vec2> t_uv;
-    Chunk *cPtr;
-
-    VBOData(Chunk *cPtr);
+    // The mesh, moved here from the worker and uploaded straight from
+    // it, or null if only the levels of detail were rebuilt
+    uPtr<MeshBuffers> mesh;
+    // The Chunk's levels of detail, level l at index l - 1
+    std::array<uPtr<MeshBuffers>, LOD_LEVELS> lods;
+    ChunkData *cPtr;
+    // True if this replaces the mesh of an edited Chunk rather than
+    // being the first mesh of a newly generated one
+    bool remesh;
+
+    VBOData(ChunkData *cPtr, bool remesh, uPtr<MeshBuffers> mesh);
 };
 
 
@@ -24,13 +47,43 @@ class VBOWorker : public QRunnable
 private:
     QMutex *mutex;
     std::vector<uPtr<VBOData>> *vboData;
+    // Checked before meshing, and given every mesh built; may be null
+    MeshCache *cache;
     uPtr<VBOData> vbo;
-    Chunk *cPtr;
+    ChunkData *cPtr;
+    // Taken when the worker is created, on the game thread, so that the
+    // mesh matches one consistent version of the Chunk and its
+    // neighbours no matter what is edited while it runs
+    MeshInput input;
+    // The sections to mesh: every one for a new Chunk, only the dirty
+    // ones for a remesh
+    std::bitset<SECTION_COUNT> sections;
+    MeshMode mode;
+    LodSampling lodSampling;
+    // Set when only a frozen Chunk's levels of detail are rebuilt, from
+    // this copy of its tree
+    uPtr<ChunkTree> tree;
+
+    // Meshes the Chunk, and its levels of detail, from input
+    void meshChunk();
 
 public:
     VBOWorker(QMutex *mutex,
               std::vector<uPtr<VBOData>> *vboData,
-              Chunk *cPtr);
+              MeshBufferPool *pool,
+              MeshCache *cache,
+              ChunkData *cPtr,
+              bool remesh = false,
+              MeshMode mode = GREEDY,
+              LodSampling lodSampling = TOP_SURFACE);
+    // Rebuilds only the levels of detail of a frozen Chunk, from its
+    // tree, so that the Chunk stays compressed
+    VBOWorker(QMutex *mutex,
+              std::vector<uPtr<VBOData>> *vboData,
+              MeshBufferPool *pool,
+              ChunkData *cPtr,
+              const ChunkTree &tree,
+              LodSampling lodSampling);
 
     void run() override;
 };
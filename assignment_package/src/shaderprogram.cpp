@@ -3,6 +3,7 @@
 #include <QStringBuilder>
 #include <QTextStream>
 #include <QDebug>
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 
@@ -11,7 +12,7 @@ ShaderProgram::ShaderProgram(OpenGLContext *context)
     : vertShader(), fragShader(), prog(),
       attrPos(-1), attrNor(-1), attrCol(-1), attrAnimateable(-1),
       unifModel(-1), unifModelInvTr(-1), unifViewProj(-1), unifColor(-1), unifTime(-1),
-      unifEye(-1), unifDimensions(-1), context(context)
+      unifEye(-1), unifDimensions(-1), unifFaces(-1), context(context)
 {}
 
 void ShaderProgram::create(const char *vertfile, const char *fragfile)
@@ -76,6 +77,7 @@ void ShaderProgram::create(const char *vertfile, const char *fragfile)
     unifTime = context->glGetUniformLocation(prog, "u_Time");
     unifEye = context->glGetUniformLocation(prog, "u_Eye");
     unifDimensions = context->glGetUniformLocation(prog, "u_Dimensions");
+    unifFaces = context->glGetUniformLocation(prog, "u_Faces");
 }
 
 void ShaderProgram::useMe()
@@ -266,7 +268,7 @@ void ShaderProgram::printLinkInfoLog(int prog)
     }
 }
 
-void ShaderProgram::drawChunk(Chunk &c){
+void ShaderProgram::drawChunk(ChunkMesh &c, QuadIndices &quads, int minSection, int maxSection){
     useMe();
 
     if(c.elemCount() < 0) {
@@ -274,92 +276,61 @@ void ShaderProgram::drawChunk(Chunk &c){
                                 std::to_string(c.elemCount()) + "!");
     }
 
-    if(c.bindPosNorCol()){
-        if (attrPos != -1) {
-            context->glEnableVertexAttribArray(attrPos);
-            context->glVertexAttribPointer(attrPos, 4, GL_FLOAT, false, 4 * sizeof(glm::vec4), (void*)0);
+    // Chunks have no vertex attributes: the shader reads each corner's
+    // face from the faces' buffer texture
+    context->glActiveTexture(GL_TEXTURE0 + FACE_TEXTURE_UNIT);
+    bool bound = c.bindFaces();
+    context->glActiveTexture(GL_TEXTURE0);
+    if (bound) {
+        if (minSection <= 0 && maxSection >= SECTION_COUNT - 1) {
+            drawQuads(c.faceRanges(), quads);
+        } else {
+            c.faceRanges(minSection, maxSection, &sectionRanges);
+            drawQuads(sectionRanges, quads);
         }
-
-        if (attrNor != -1) {
-            context->glEnableVertexAttribArray(attrNor);
-            context->glVertexAttribPointer(attrNor, 4, GL_FLOAT, false, 4 * sizeof(glm::vec4), (void*)sizeof(glm::vec4));
-        }
-
-        if (attrCol != -1) {
-            context->glEnableVertexAttribArray(attrCol);
-            context->glVertexAttribPointer(attrCol, 4, GL_FLOAT, false, 4 * sizeof(glm::vec4), (void *)(2 * sizeof(glm::vec4)));
-        }
-        if (attrAnimateable != -1) {
-            context->glEnableVertexAttribArray(attrAnimateable);
-            context->glVertexAttribPointer(attrAnimateable, 1, GL_FLOAT, false, 4 * sizeof(glm::vec4), (void *)(3 * sizeof(glm::vec4)));
-        }
-    }
-
-    if (unifSampler2D != -1) {
-        context->glUniform1i(unifSampler2D, 0);
     }
-
-    if (attrUV != -1 && c.bindUV()) {
-        context->glEnableVertexAttribArray(attrUV);
-        context->glVertexAttribPointer(attrUV, 2, GL_FLOAT, false, 0, NULL);
-    }
-
-    c.bindIdx();
-    context->glDrawElements(c.drawMode(), c.elemCount(), GL_UNSIGNED_INT, 0);
-
-    if (attrPos != -1) context->glDisableVertexAttribArray(attrPos);
-    if (attrNor != -1) context->glDisableVertexAttribArray(attrNor);
-    if (attrCol != -1) context->glDisableVertexAttribArray(attrCol);
-    if (attrUV != -1) context->glDisableVertexAttribArray(attrUV);
     context->printGLErrorLog();
 }
 
-void ShaderProgram::drawTransChunk(Chunk &c){
+void ShaderProgram::drawTransChunk(ChunkMesh &c, QuadIndices &quads, int minSection, int maxSection){
     useMe();
 
-    if(c.elemCount() < 0) {
-        throw std::out_of_range("Attempting to draw a drawable with m_count of " +
-                                std::to_string(c.elemCount()) + "!");
+    if(c.transElemCount() < 0) {
+        throw std::out_of_range("Attempting to draw a drawable with m_transCount of " +
+                                std::to_string(c.transElemCount()) + "!");
     }
 
-    if(c.bindTransPosNorCol()){
-        if (attrPos != -1) {
-            context->glEnableVertexAttribArray(attrPos);
-            context->glVertexAttribPointer(attrPos, 4, GL_FLOAT, false, 4 * sizeof(glm::vec4), (void*)0);
-        }
-
-        if (attrNor != -1) {
-            context->glEnableVertexAttribArray(attrNor);
-            context->glVertexAttribPointer(attrNor, 4, GL_FLOAT, false, 4 * sizeof(glm::vec4), (void*)sizeof(glm::vec4));
-        }
-
-        if (attrCol != -1) {
-            context->glEnableVertexAttribArray(attrCol);
-            context->glVertexAttribPointer(attrCol, 4, GL_FLOAT, false, 4 * sizeof(glm::vec4), (void *)(2 * sizeof(glm::vec4)));
-        }
-        if (attrAnimateable != -1) {
-            context->glEnableVertexAttribArray(attrAnimateable);
-            context->glVertexAttribPointer(attrAnimateable, 1, GL_FLOAT, false, 4 * sizeof(glm::vec4), (void *)(3 * sizeof(glm::vec4)));
+    context->glActiveTexture(GL_TEXTURE0 + FACE_TEXTURE_UNIT);
+    bool bound = c.bindTransFaces();
+    context->glActiveTexture(GL_TEXTURE0);
+    if (bound) {
+        if (minSection <= 0 && maxSection >= SECTION_COUNT - 1) {
+            drawQuads(c.transFaceRanges(), quads);
+        } else {
+            c.transFaceRanges(minSection, maxSection, &sectionRanges);
+            drawQuads(sectionRanges, quads);
         }
     }
+    context->printGLErrorLog();
+}
 
+void ShaderProgram::drawQuads(const std::vector<FaceRange> &ranges, QuadIndices &quads) {
     if (unifSampler2D != -1) {
         context->glUniform1i(unifSampler2D, 0);
     }
-
-    if (attrUV != -1 && c.bindTransUV()) {
-        context->glEnableVertexAttribArray(attrUV);
-        context->glVertexAttribPointer(attrUV, 2, GL_FLOAT, false, 0, NULL);
+    if (unifFaces != -1) {
+        context->glUniform1i(unifFaces, FACE_TEXTURE_UNIT);
     }
 
-    c.bindTransIdx();
-    context->glDrawElements(c.drawMode(), c.elemCount(), GL_UNSIGNED_INT, 0);
-
-    if (attrPos != -1) context->glDisableVertexAttribArray(attrPos);
-    if (attrNor != -1) context->glDisableVertexAttribArray(attrNor);
-    if (attrCol != -1) context->glDisableVertexAttribArray(attrCol);
-    if (attrUV != -1) context->glDisableVertexAttribArray(attrUV);
-    context->printGLErrorLog();
+    quads.bindIdx();
+    const uint32_t batch = QuadIndices::QUAD_COUNT;
+    for(const FaceRange &range : ranges) {
+        for(uint32_t done = 0; done < range.count; done += batch) {
+            // Every batch starts over at index 0, offset by its first vertex
+            context->glDrawElementsBaseVertex(GL_TRIANGLES, std::min(batch, range.count - done) * 6,
+                                              GL_UNSIGNED_SHORT, 0, (range.first + done) * 4);
+        }
+    }
 }
 
 void ShaderProgram::setTime(int t) {
@@ -6,7 +6,7 @@
 #include <glm/glm.hpp>
 
 #include "drawable.h"
-#include "scene/chunk.h"
+#include "scene/chunkmesh.h"
 
 class ShaderProgram
 {
@@ -29,6 +29,11 @@ public:
     int unifTime;
     int unifEye;
     int unifDimensions;
+    int unifFaces; // A handle for the "uniform" usamplerBuffer holding a Chunk's faces (see ChunkFace)
+
+    // The texture unit Chunk faces are read from. Unit 0 holds the
+    // block atlas.
+    static const int FACE_TEXTURE_UNIT = 1;
 
 public:
     ShaderProgram(OpenGLContext* context);
@@ -57,10 +62,21 @@ public:
     QString qTextFileRead(const char*);
 
     // Milestone 1
-    void drawChunk(Chunk &c);
-    void drawTransChunk(Chunk &c);
+    // Chunks have no vertices or indices of their own; they are drawn
+    // with the shared quad indices from their faces' buffer texture.
+    // Only the faces of sections minSection to maxSection are drawn.
+    void drawChunk(ChunkMesh &c, QuadIndices &quads,
+                   int minSection = 0, int maxSection = SECTION_COUNT - 1);
+    void drawTransChunk(ChunkMesh &c, QuadIndices &quads,
+                        int minSection = 0, int maxSection = SECTION_COUNT - 1);
 
 private:
+    // Draws the given runs of faces of the bound Chunk face buffer,
+    // one batch per QuadIndices::QUAD_COUNT quads
+    void drawQuads(const std::vector<FaceRange> &ranges, QuadIndices &quads);
+    // Scratch space for the runs of faces of some of a Chunk's sections
+    std::vector<FaceRange> sectionRanges;
+
     OpenGLContext* context;   // Since Qt's OpenGL support is done through classes like QOpenGLFunctions_3_2_Core,
                             // we need to pass our OpenGL context to the Drawable in order to call GL functions
                             // from within this class.
@@ -22,7 +22,12 @@ SOURCES += \
     $$PWD/scene/player.cpp \
     $$PWD/scene/camera.cpp \
     $$PWD/playerinfo.cpp \
-    $$PWD/scene/chunk.cpp
+    $$PWD/scene/chunkdata.cpp \
+    $$PWD/scene/chunkmesh.cpp \
+    $$PWD/scene/chunktree.cpp \
+    $$PWD/scene/facecull.cpp \
+    $$PWD/scene/meshcache.cpp \
+    $$PWD/scene/chunkpool.cpp
 
 HEADERS += \
     $$PWD/mainwindow.h \
@@ -46,4 +51,10 @@ HEADERS += \
     $$PWD/scene/player.h \
     $$PWD/scene/camera.h \
     $$PWD/playerinfo.h \
-    $$PWD/scene/chunk.h
+    $$PWD/scene/blockregistry.h \
+    $$PWD/scene/chunkdata.h \
+    $$PWD/scene/chunkmesh.h \
+    $$PWD/scene/chunktree.h \
+    $$PWD/scene/facecull.h \
+    $$PWD/scene/meshcache.h \
+    $$PWD/scene/chunkpool.h